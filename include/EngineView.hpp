@@ -0,0 +1,48 @@
+#pragma once
+#include "controller/EnginePlayer.hpp"
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Shows what the computer is thinking: the score as a bar beside the board and the first moves of its
+ *        principal variation as arrows over it.
+ * @details No font ships with the game, so describe gives the search as text for the window title.
+ */
+class EngineView : public sf::Drawable {
+private:
+    static constexpr float bar_width = 24;
+    static constexpr float margin = 10;
+    /// Moves of the principal variation drawn as arrows.
+    static constexpr int shown_moves = 4;
+    /// Moves of the principal variation given by describe.
+    static constexpr int described_moves = 8;
+    static constexpr float arrow_thickness = 8;
+    const sf::FloatRect m_board;
+    sf::VertexArray m_vertices;
+    std::string m_description;
+
+    void addRectangle(sf::Vector2f top_left, sf::Vector2f size, sf::Color color);
+    void addArrow(int from, int to, sf::Color color);
+    sf::Vector2f squareCenter(int square) const;
+
+public:
+    /**
+     * @param board Area of the target covered by the board, with White at the bottom.
+     */
+    explicit EngineView(const sf::FloatRect& board);
+
+    /**
+     * @brief Shows the latest report of a search.
+     * @param line Principal variation from the position on the board. It starts with the predicted move while
+     *             pondering, since the engine searches the position after it.
+     */
+    void show(const EngineReport& report, const std::vector<Move>& line, bool pondering);
+    void clear();
+
+    /**
+     * @brief Returns the depth, score and principal variation of the search shown, or an empty string.
+     */
+    const std::string& describe() const;
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates state) const;
+};
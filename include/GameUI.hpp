@@ -1,6 +1,7 @@
 #pragma once
 #include "model/GameState.hpp"
 #include <SFML/Graphics.hpp>
+#include <cstdint>
 #include <optional>
 
 class GameUI : public sf::Drawable {
@@ -12,11 +13,51 @@ private:
     std::array<sf::Sprite, 12> pieces_sprites;
     GameState& m_game;
     std::optional<BoardCoordinate> last_square;
+    /// Where the dragged piece is drawn, following the mouse move events.
+    sf::Vector2f m_drag_position;
     sf::Texture pieces_texture;
+    /// The 64 squares as colored quads, built once.
+    sf::VertexArray m_squares_vertices;
+    /// The pieces not being dragged as textured quads, rebuilt only when the position or the dragged piece changes.
+    mutable sf::VertexArray m_pieces_vertices;
+    mutable std::uint64_t m_built_generation;
+    /// Square left out of m_pieces_vertices because its piece is being dragged, or -1.
+    mutable int m_built_hidden_square;
+    bool m_input_enabled;
+
+    /**
+     * @brief Returns the index of the sprite and of the texture tile of a piece.
+     */
+    static int spriteIndex(const Piece& piece);
+
+    /**
+     * @brief Rebuilds m_pieces_vertices if the position or the dragged piece changed since it was built.
+     */
+    void updatePiecesVertices() const;
+    static bool isOnBoard(const sf::Vector2f& position);
 
 public:
+    /**
+     * @brief Returns the area of the target covered by the board.
+     */
+    static sf::FloatRect boardArea();
     GameUI(GameState& new_game);
     virtual void draw(sf::RenderTarget& target, sf::RenderStates state) const;
     BoardCoordinate fromUiCoordsToBoardCoords(float pos_x, float pos_y);
-    void update(sf::RenderWindow& window);
+
+    /**
+     * @brief Picks up, drags and drops pieces following the mouse events of the window.
+     * @return Whether the board has to be drawn again.
+     */
+    bool handleEvent(const sf::Event& event, const sf::RenderTarget& target);
+
+    /**
+     * @brief Lets the mouse pick up pieces or not, for example while the computer is to move.
+     */
+    void setInputEnabled(bool enabled);
+
+    /**
+     * @brief Returns whether the position changed since the board was last drawn, for example by a move made elsewhere.
+     */
+    bool isStale() const;
 };
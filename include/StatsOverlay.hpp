@@ -0,0 +1,45 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Graphs of the time taken by the last frames, drawn over the board.
+ * @details The upper graph is the frame time, green within the 60 FPS budget and red over it, and the lower graph is
+ *          the time spent validating moves during each frame, on a scale of one millisecond. No font ships with the
+ *          game, so describe gives the figures as text for the window title. Move validation is only measured when
+ *          built with CHESS_STATS.
+ */
+class StatsOverlay : public sf::Drawable {
+private:
+    static constexpr int history_size = 120;
+    static constexpr float bar_width = 2;
+    static constexpr float graph_height = 60;
+    static constexpr float margin = 10;
+    std::array<std::uint64_t, history_size> m_frame_nanoseconds;
+    std::array<std::uint64_t, history_size> m_validation_nanoseconds;
+    /// Index of the oldest frame, which the next one replaces.
+    int m_next;
+    bool m_visible;
+    sf::VertexArray m_vertices;
+
+    void addRectangle(float left, float top, float width, float height, sf::Color color);
+    void rebuild();
+
+public:
+    StatsOverlay();
+    void toggle();
+    bool isVisible() const;
+
+    /**
+     * @brief Adds a frame to the graphs.
+     */
+    void addFrame(std::uint64_t frame_nanoseconds, std::uint64_t validation_nanoseconds);
+
+    /**
+     * @brief Returns the average and worst frame time and the average validation time of the last frames.
+     */
+    std::string describe() const;
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates state) const;
+};
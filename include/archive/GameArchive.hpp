@@ -0,0 +1,154 @@
+#pragma once
+#include "../io/MappedFile.hpp"
+#include "../model/GameState.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+enum class GameResult : std::uint8_t {
+    Unknown = 0,
+    WhiteWins = 1,
+    BlackWins = 2,
+    Draw = 3
+};
+
+/**
+ * @brief Layout of game archives, shared by GameArchiveWriter and GameArchive.
+ * @details An archive is two files. The games file starts with an 8 byte magic and holds the games one after the
+ *          other. Each game is a 4 byte header (the number of plies as a little-endian 16 bit integer, the GameResult
+ *          and a flags byte), the start position packed like a CompactPosition if bit 0 of the flags is set, and one
+ *          byte per ply: the index of the move in the legal moves of the position as listed by
+ *          ArchiveFormat::legalMoves, which sorts them so that archives do not depend on the order of the move
+ *          generator. The index file, named like the games file plus index_extension, starts with its own
+ *          magic and holds the offset of each game in the games file as a little-endian 64 bit integer, so game N
+ *          is found with a single read.
+ */
+namespace ArchiveFormat {
+    constexpr std::size_t magic_size = 8;
+    constexpr char games_magic[magic_size] = { 'C', 'H', 'E', 'S', 'S', 'G', 'A', '2' };
+    constexpr char index_magic[magic_size] = { 'C', 'H', 'E', 'S', 'S', 'G', 'I', '2' };
+    constexpr const char* index_extension = ".idx";
+    constexpr std::size_t game_header_size = 4;
+    /// Bytes of a start position: occupancy, piece codes, halfmove clock, fullmove number, flags and en passant column.
+    constexpr std::size_t position_size = 30;
+    constexpr std::uint8_t custom_start_flag = 1;
+    constexpr std::size_t max_plies = 0xFFFF;
+
+    /**
+     * @brief Writes the legal moves of the position in the order their indices refer to: increasing Move::getData.
+     * @details Changing this order changes the meaning of every archive, so it needs new magics.
+     */
+    void legalMoves(const GameState& state, MoveList& moves);
+
+    /**
+     * @brief Appends the bytes of a game to a buffer. The caller must have checked that every index is the one of a
+     *        legal move and that there are at most max_plies of them.
+     * @param move_indices The index of each move in the legal moves of the position it was played in.
+     */
+    void encodeGame(const CompactPosition& start, const std::vector<std::uint8_t>& move_indices, GameResult result,
+        std::vector<unsigned char>& bytes);
+}
+
+/**
+ * @brief Appends games to an archive as they finish.
+ * @details The games are buffered by the streams, so call flush to make them visible to readers.
+ */
+class GameArchiveWriter {
+private:
+    std::ofstream m_games;
+    std::ofstream m_index;
+    std::uint64_t m_offset;
+    /// Reused between games, so appending does not allocate once the buffer is large enough.
+    GameState m_state;
+    std::vector<std::uint8_t> m_move_indices;
+    std::vector<unsigned char> m_buffer;
+
+public:
+    /**
+     * @brief Opens the archive at the given path, creating it if it does not exist. Throws std::runtime_error if it
+     *        cannot be opened or is not an archive.
+     */
+    explicit GameArchiveWriter(const std::string& path);
+
+    /**
+     * @brief Appends a game played from the given position. Throws std::invalid_argument, without writing anything,
+     *        if a move is not legal or the game is longer than ArchiveFormat::max_plies.
+     */
+    void append(const GameState& start, const std::vector<Move>& moves, GameResult result);
+
+    /**
+     * @brief Appends a game played from the initial position.
+     */
+    void append(const std::vector<Move>& moves, GameResult result);
+
+    /**
+     * @brief Appends a game encoded with ArchiveFormat::encodeGame, without checking it. Lets games be encoded by many
+     *        threads while they are written in order by one.
+     */
+    void appendEncoded(const unsigned char* game, std::size_t size);
+
+    /**
+     * @brief Writes the buffered games to disk. Throws std::runtime_error if they cannot be written.
+     */
+    void flush();
+};
+
+/**
+ * @brief A game of an archive, pointing into its mapped file.
+ */
+class ArchivedGame {
+private:
+    const unsigned char* m_data;
+    std::size_t m_plies;
+    GameResult m_result;
+
+    const unsigned char* moves() const;
+
+public:
+    ArchivedGame(const unsigned char* data, std::size_t plies, GameResult result);
+
+    std::size_t plies() const;
+    GameResult getResult() const;
+    bool hasCustomStart() const;
+
+    /**
+     * @brief Replaces the position of the state with the start of the game, reusing its storage.
+     */
+    void loadStart(GameState& state) const;
+
+    /**
+     * @brief Returns the move of the given ply, which state must be the position before.
+     * @details Generates the legal moves of the position on the stack, so replaying a game with GameState::move does
+     *          not allocate. Throws std::runtime_error if the stored index is not a legal move.
+     */
+    Move moveAt(const GameState& state, std::size_t ply) const;
+};
+
+/**
+ * @brief Reads a game archive mapped into memory.
+ */
+class GameArchive {
+private:
+    MappedFile m_games;
+    MappedFile m_index;
+    std::size_t m_size;
+
+public:
+    /**
+     * @brief Maps the archive at the given path. Throws std::runtime_error if it cannot be opened or is not an archive.
+     */
+    explicit GameArchive(const std::string& path);
+
+    /**
+     * @brief Returns the number of games.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Returns the game at the given position, in the order they were appended.
+     * @details Throws std::out_of_range if there is no such game, or std::runtime_error if it runs past the end of the
+     *          file.
+     */
+    ArchivedGame game(std::size_t index) const;
+};
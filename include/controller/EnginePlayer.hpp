@@ -0,0 +1,101 @@
+#pragma once
+#include "../engine/Engine.hpp"
+#include "../model/GameState.hpp"
+#include "Mailbox.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+/// Progress of a search of the EnginePlayer.
+struct EngineReport {
+    /// Identifier of the search, as returned by EnginePlayer::think and EnginePlayer::ponder.
+    std::uint64_t search = 0;
+    /// Whether the search is over, in which case best_move is the move to play.
+    bool finished = false;
+    /// Null if the position has no legal moves.
+    Move best_move;
+    std::vector<Move> pv;
+    /// Score in centipawns from the point of view of White. See Score for mate scores.
+    int white_score = 0;
+    int depth = 0;
+    std::uint64_t nodes = 0;
+};
+
+/**
+ * @brief Runs an Engine on a thread of its own, so that the game window keeps drawing while it searches.
+ * @details Every search works on a copy of the position taken when it is requested. Requests are handed to the search
+ *          thread under a mutex that is never held while searching, and a new request stops the search in progress.
+ *          Searches are prepared while the mutex is held, so that a stop sent before one starts is never lost. The
+ *          search thread publishes a report after every iteration and when it is done through a Mailbox, which the game
+ *          polls every frame without ever waiting.
+ */
+class EnginePlayer {
+private:
+    struct Request {
+        std::uint64_t search;
+        GameState state;
+        SearchLimits limits;
+    };
+
+    Engine m_engine;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    /// Request not picked up by the search thread yet, guarded by m_mutex.
+    std::optional<Request> m_pending;
+    /// Whether the search thread must exit, guarded by m_mutex.
+    bool m_quit;
+    /// Identifier of the latest request.
+    std::atomic<std::uint64_t> m_latest_search;
+    /// Time since the epoch of the steady clock, in nanoseconds, at which the current search must stop, or 0.
+    std::atomic<std::int64_t> m_deadline;
+    Mailbox<EngineReport> m_reports;
+    std::thread m_thread;
+
+    void run();
+    std::uint64_t request(const GameState& state, const SearchLimits& limits);
+
+public:
+    /**
+     * @param threads Search threads of the engine.
+     * @param book Opening book to play from, or null.
+     */
+    EnginePlayer(int threads, std::shared_ptr<const OpeningBook> book);
+    ~EnginePlayer();
+    EnginePlayer(const EnginePlayer&) = delete;
+    EnginePlayer& operator=(const EnginePlayer&) = delete;
+
+    /**
+     * @brief Starts searching a copy of the position for a move to play within the given time.
+     * @return The identifier of the search, found in its reports.
+     */
+    std::uint64_t think(const GameState& state, int movetime);
+
+    /**
+     * @brief Starts searching a copy of the position until stopped, to get ahead while the opponent thinks.
+     * @return The identifier of the search, found in its reports.
+     */
+    std::uint64_t ponder(const GameState& state);
+
+    /**
+     * @brief Turns the pondering search into one that finishes within the given time, because the opponent played
+     *        the move it was pondering on.
+     */
+    void ponderHit(int movetime);
+
+    /**
+     * @brief Stops the search in progress, if any, and discards the pending request.
+     */
+    void cancel();
+
+    /**
+     * @brief Returns the latest report published since the last call, or nullptr if there is none. Never blocks.
+     * @details The report stays valid until the next call.
+     */
+    const EngineReport* poll();
+};
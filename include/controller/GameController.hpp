@@ -1,14 +1,81 @@
 #pragma once
+#include "../EngineView.hpp"
 #include "../GameUI.hpp"
+#include "../StatsOverlay.hpp"
 #include "../model/GameState.hpp"
+#include "EnginePlayer.hpp"
 #include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <optional>
+#include <string>
 
 class GameController {
+    /// Rate at which events are handled and the board is redrawn if it changed.
+    static constexpr int frames_per_second = 60;
+    static constexpr const char* window_title = "New Game - Chess.cpp";
+    static constexpr const char* stats_file = "chess_stats.json";
+    /// Opening book the computer plays from, if the file exists.
+    static constexpr const char* book_file = "book.bin";
+    /// Time the computer takes for each move, in milliseconds.
+    static constexpr int engine_move_time = 1000;
+
+    enum class EngineTask {
+        Idle,
+        /// Searching for the move to play.
+        Thinking,
+        /// Searching the position after the predicted reply while the player thinks.
+        Pondering
+    };
+
     sf::RenderWindow m_window;
     GameState m_game;
     GameUI m_view;
+    StatsOverlay m_stats_overlay;
+    EngineView m_engine_view;
+    EnginePlayer m_engine;
+    /// Side played by the computer, or none if both sides are played with the mouse.
+    std::optional<PieceColor> m_engine_color;
+    EngineTask m_engine_task;
+    /// Identifier of the search of m_engine_task.
+    std::uint64_t m_engine_search;
+    /// Latest report of that search.
+    EngineReport m_engine_report;
+    /// Reply the computer expects to its last move, or a null move.
+    Move m_ponder_move;
+    /// Hash of the position after m_ponder_move, which is being pondered on.
+    std::uint64_t m_ponder_hash;
+    /// Generation of m_game when the computer last looked at it.
+    std::uint64_t m_engine_generation;
+    std::string m_title;
+
+    /**
+     * @brief Receives the reports of the engine, plays its move once found, and starts a new search whenever the
+     *        position changed.
+     * @return Whether the board has to be drawn again.
+     */
+    bool updateEngine();
+
+    /**
+     * @brief Decides what the computer does in the current position: think on its turn, ponder on the player's.
+     */
+    void startEngine();
+    void playEngineMove();
+
+    /**
+     * @brief Shows the search of the computer and the statistics overlay in the window title, if any.
+     */
+    void updateTitle();
 
 public:
     GameController();
+
+    /**
+     * @brief Runs the event loop until the window is closed.
+     * @details Every frame drains the event queue, polls the engine, redraws the board only if an event or a move
+     *          changed it, and sleeps for the rest of the frame. The engine searches on its own thread, so the window
+     *          never waits for it. F2 makes the computer play Black, White or neither, in turn. F3 toggles the
+     *          statistics overlay, which redraws every frame while it is shown. When built with CHESS_STATS, the
+     *          statistics are written to stats_file on exit.
+     */
     void run();
-};
\ No newline at end of file
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <array>
+#include <atomic>
+
+/**
+ * @brief Hands the latest value from one producer thread to one consumer thread without locks.
+ * @details A triple buffer: the producer fills its own slot and swaps it with the shared one, the consumer swaps the
+ *          shared slot with its own when it holds a value not read yet. Neither thread ever waits for the other, and a
+ *          value the consumer did not read in time is replaced by the next one. Slots are assigned to, so values that
+ *          own memory reuse it once every slot has been filled.
+ */
+template <typename T>
+class Mailbox {
+private:
+    /// Set in m_shared when the shared slot holds a value the consumer has not received.
+    static constexpr unsigned fresh = 4;
+    std::array<T, 3> m_slots;
+    std::atomic<unsigned> m_shared;
+    /// Slot owned by the producer.
+    unsigned m_writing;
+    /// Slot owned by the consumer.
+    unsigned m_reading;
+
+public:
+    Mailbox()
+        : m_slots()
+        , m_shared(0)
+        , m_writing(1)
+        , m_reading(2)
+    {
+    }
+
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+
+    /**
+     * @brief Replaces the value waiting for the consumer. Only to be called by the producer thread.
+     */
+    void publish(const T& value)
+    {
+        m_slots[m_writing] = value;
+        m_writing = m_shared.exchange(m_writing | fresh, std::memory_order_acq_rel) & ~fresh;
+    }
+
+    /**
+     * @brief Returns the latest value published since the last call, or nullptr if there is none. Only to be called
+     *        by the consumer thread; the value stays valid until its next call.
+     */
+    const T* receive()
+    {
+        if ((m_shared.load(std::memory_order_relaxed) & fresh) == 0) {
+            return nullptr;
+        }
+        m_reading = m_shared.exchange(m_reading, std::memory_order_acq_rel) & ~fresh;
+        return &m_slots[m_reading];
+    }
+};
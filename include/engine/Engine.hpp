@@ -0,0 +1,69 @@
+#pragma once
+#include "OpeningBook.hpp"
+#include "SearchWorker.hpp"
+#include <atomic>
+#include <memory>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Searches a position for the best move.
+ * @details Runs a negamax alpha-beta search with principal variation windows inside iterative deepening. Iterations
+ *          after the first few start from an aspiration window around the previous score. Leaves are resolved with a
+ *          quiescence search over captures and promotions. Results are cached in a transposition table that persists
+ *          between searches.
+ *
+ *          With more than one thread the search is a lazy SMP: every thread searches the same root on its own copy of
+ *          the position, and they cooperate only through the shared transposition table. The result is the one of the
+ *          main thread.
+ */
+class Engine {
+public:
+    static constexpr int max_ply = SearchWorker::max_ply;
+
+private:
+    TranspositionTable m_table;
+    std::atomic<bool> m_stop;
+    /// Set by prepareSearch, so that the next search keeps a stop requested before it started.
+    std::atomic<bool> m_prepared;
+    std::vector<std::unique_ptr<SearchWorker>> m_workers;
+    std::shared_ptr<const OpeningBook> m_book;
+    std::mt19937_64 m_book_random;
+
+public:
+    explicit Engine(std::size_t hash_megabytes = 16, int threads = 1);
+
+    /**
+     * @brief Searches the position on every thread and returns once the search is over.
+     * @details If the position is in the opening book, returns one of its book moves right away instead, with a depth
+     *          of 0.
+     * @param on_iteration Called on the calling thread with the intermediate result after every completed iteration.
+     */
+    SearchResult search(const GameState& state, const SearchLimits& limits, const IterationCallback& on_iteration = nullptr);
+
+    /**
+     * @brief Asks a running search to return as soon as possible. Safe to call from any thread.
+     * @details After prepareSearch, also stops the prepared search if it has not started yet.
+     */
+    void stop();
+
+    /**
+     * @brief Readies the next call to search, so that a stop sent between now and its start is not lost.
+     * @details Call it before handing the search to another thread. Without it, search clears any earlier stop.
+     */
+    void prepareSearch();
+    void setHashSize(std::size_t megabytes);
+    void clearHash();
+
+    /**
+     * @brief Returns how full the transposition table is in permille.
+     */
+    int hashfull() const;
+    void setThreads(int threads);
+
+    /**
+     * @brief Sets the opening book consulted before searching, or disables it if the book is null.
+     */
+    void setBook(std::shared_ptr<const OpeningBook> book);
+    int getThreads() const;
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include "../model/GameState.hpp"
+#include <array>
+
+namespace Score {
+    constexpr int Draw = 0;
+    constexpr int Mate = 32000;
+    constexpr int Infinite = 32001;
+
+    /// Scores beyond this bound are mates, whose distance to mate in plies is Mate minus the score.
+    constexpr int MateBound = Mate - 1000;
+}
+
+namespace Evaluation {
+    /// Value of each piece in centipawns, indexed by PieceType, used to order captures.
+    constexpr std::array<int, 6> piece_values = { 0, 900, 330, 320, 500, 100 };
+
+    /**
+     * @brief Returns the static score of the position in centipawns, from the point of view of the player to move.
+     * @details Tapers the material and piece-square terms that GameState keeps up to date between the middlegame and
+     *          the endgame by the game phase, so no square of the board is read.
+     */
+    int evaluate(const GameState& state);
+
+    /**
+     * @brief Returns the material won by a capture once every recapture on its square is played out, in centipawns.
+     * @details Both sides recapture with their least valuable piece and can stop when continuing would lose material.
+     *          Pinned pieces are not taken into account.
+     */
+    int staticExchange(const GameState& state, Move move);
+}
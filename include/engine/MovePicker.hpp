@@ -0,0 +1,104 @@
+#pragma once
+#include "../model/GameState.hpp"
+#include <array>
+
+/**
+ * @brief Scores of quiet moves by the color that plays them, their source and their destiny.
+ * @details Raised for moves that cause beta cutoffs and lowered for the quiet moves searched before them, so the scores
+ *          estimate how often a move refutes the positions of the current search.
+ */
+class HistoryTable {
+public:
+    /// Scores stay within plus and minus this bound.
+    static constexpr int max_score = 1 << 14;
+
+private:
+    std::array<std::array<std::array<int, 64>, 64>, 2> m_scores;
+
+public:
+    HistoryTable();
+    void clear();
+    int get(PieceColor color, Move move) const;
+
+    /**
+     * @brief Moves a score towards the bound by the given bonus, less so the closer it already is.
+     */
+    void update(PieceColor color, Move move, int bonus);
+};
+
+/**
+ * @brief Yields the legal moves of a position in the order they are most likely to cause a beta cutoff.
+ * @details Moves come in stages, and each stage only generates the moves it needs, so a cutoff on an early move never
+ *          pays for generating the later ones:
+ *          1. the hash move,
+ *          2. captures and promotions that do not lose material, by most valuable victim and least valuable attacker,
+ *          3. the two killer moves of the ply and the countermove to the previous move, if they are legal quiets,
+ *          4. the other quiet moves, by history score,
+ *          5. captures that lose material according to the static exchange evaluation.
+ *          In quiescence mode only stages 1, 2 and 5 run, unless the side to move is in check.
+ */
+class MovePicker {
+private:
+    enum class Stage {
+        HashMove,
+        GenerateCaptures,
+        GoodCaptures,
+        FirstKiller,
+        SecondKiller,
+        Countermove,
+        GenerateQuiets,
+        Quiets,
+        BadCaptures,
+        Done
+    };
+
+    const GameState& m_state;
+    const HistoryTable& m_history;
+    Stage m_stage;
+    const Move m_hash_move;
+    const std::array<Move, 2> m_killers;
+    const Move m_countermove;
+    const bool m_skip_quiets;
+    MoveList m_moves;
+    std::array<int, MoveList::capacity> m_scores;
+    std::size_t m_index;
+    MoveList m_bad_captures;
+    std::size_t m_bad_index;
+
+    /**
+     * @brief Returns whether a move from a table is legal in the position. It must have come from some position of
+     *        the same game, so it may be anything.
+     */
+    bool isLegal(Move move) const;
+
+    /**
+     * @brief Returns whether a quiet move was already yielded by an earlier stage.
+     */
+    bool wasYielded(Move move) const;
+    void scoreCaptures();
+    void scoreQuiets();
+
+    /**
+     * @brief Moves the best scored of the remaining moves to the current index and returns it.
+     */
+    Move pickBest();
+
+public:
+    /**
+     * @brief Picks the moves of a node of the main search.
+     * @param killers Quiet moves that caused cutoffs at the same ply of sibling nodes.
+     * @param countermove The quiet move that last refuted the move that led to this position.
+     */
+    MovePicker(const GameState& state, const HistoryTable& history, Move hash_move, const std::array<Move, 2>& killers,
+        Move countermove);
+
+    /**
+     * @brief Picks the captures and promotions of a quiescence node, or every move if the side to move is in check.
+     */
+    MovePicker(const GameState& state, const HistoryTable& history, Move hash_move);
+
+    /**
+     * @brief Returns the next move, or a null move once every move was yielded.
+     */
+    Move next();
+};
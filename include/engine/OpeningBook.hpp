@@ -0,0 +1,83 @@
+#pragma once
+#include "../model/GameState.hpp"
+#include "../io/MappedFile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct BookMove {
+    Move move;
+    /// Relative weight of the move among the book moves of the position.
+    std::uint16_t weight;
+};
+
+/**
+ * @brief Opening book in the Polyglot .bin format, mapped read-only into memory.
+ * @details A book is a sorted array of 16 byte big-endian entries (key, move, weight, learn), so the file is mapped as
+ *          it is and searched in place: opening a book neither parses nor copies it, and processes that open the same
+ *          book share its pages.
+ *
+ *          The entries are keyed by polyglotKey, so books made by other Polyglot tools can be read and books built with
+ *          chess_book can be used by other engines.
+ */
+class OpeningBook {
+public:
+    /// Size in bytes of each entry of the file.
+    static constexpr std::size_t entry_size = 16;
+
+    struct Entry {
+        std::uint64_t key;
+        std::uint16_t move;
+        std::uint16_t weight;
+        std::uint32_t learn;
+    };
+
+private:
+    MappedFile m_file;
+
+    std::uint64_t keyAt(std::size_t index) const;
+    Entry entryAt(std::size_t index) const;
+
+public:
+    /**
+     * @brief Maps the book at the given path. Throws std::runtime_error if it cannot be opened or is not a book.
+     */
+    explicit OpeningBook(const std::string& path);
+
+    /**
+     * @brief Returns the number of entries in the book.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Returns the legal book moves of the position, with their weights. Entries whose move is not legal in the
+     *        position, which only happens on hash collisions, are skipped.
+     */
+    std::vector<BookMove> lookup(const GameState& state) const;
+
+    /**
+     * @brief Picks one of the book moves of the position with a probability proportional to its weight, or returns
+     *        nullopt if the position is not in the book.
+     * @param random A uniformly distributed random number that decides the pick.
+     */
+    std::optional<Move> pickMove(const GameState& state, std::uint64_t random) const;
+
+    /**
+     * @brief Returns the key of the position in Polyglot books, made from the Random64 array of Polyglot.
+     * @details It differs from GameState::getHash, whose keys are random numbers of this program.
+     */
+    static std::uint64_t polyglotKey(const GameState& state);
+
+    /**
+     * @brief Returns a move in the 16 bit encoding of Polyglot, where castling is the king capturing its own rook.
+     */
+    static std::uint16_t encodeMove(Move move);
+
+    /**
+     * @brief Sorts the entries by key and writes them as a book. Throws std::runtime_error if the file cannot be
+     *        written.
+     */
+    static void write(const std::string& path, std::vector<Entry> entries);
+};
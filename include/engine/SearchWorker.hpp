@@ -0,0 +1,109 @@
+#pragma once
+#include "../model/GameState.hpp"
+#include "Evaluation.hpp"
+#include "MovePicker.hpp"
+#include "TranspositionTable.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct SearchLimits {
+    /// Maximum depth in plies of the iterative deepening.
+    int depth = 64;
+    /// Time budget in milliseconds, or 0 for no limit.
+    int movetime = 0;
+    /// Node budget, or 0 for no limit.
+    std::uint64_t nodes = 0;
+};
+
+struct SearchResult {
+    Move best_move;
+    std::vector<Move> pv;
+    /// Score in centipawns from the point of view of the player to move. See Score for mate scores.
+    int score = 0;
+    /// Depth of the last completed iteration.
+    int depth = 0;
+    std::uint64_t nodes = 0;
+    /// Nodes of the main search, not counting quiescence, that failed high.
+    std::uint64_t beta_cutoffs = 0;
+    /// Of those, the ones that failed high on their first move, which measures how good the move ordering is.
+    std::uint64_t first_move_cutoffs = 0;
+};
+
+/// Called by the main search thread after every completed iteration of the iterative deepening.
+using IterationCallback = std::function<void(const SearchResult&)>;
+
+/**
+ * @brief One search thread of the Engine.
+ * @details Every worker owns its copy of the position and its search stack, and shares only the transposition table
+ *          and the stop flag with the others. Helper workers skip some iterations of the iterative deepening, so that
+ *          they run ahead of the main worker at different depths and fill the table with results it will need.
+ */
+class SearchWorker {
+public:
+    static constexpr int max_ply = 128;
+
+private:
+    TranspositionTable& m_table;
+    std::atomic<bool>& m_stop;
+    const int m_id;
+    GameState m_state;
+    SearchLimits m_limits;
+    std::chrono::steady_clock::time_point m_start_time;
+    /// Read by the main worker to enforce the node limit, hence atomic.
+    std::atomic<std::uint64_t> m_nodes;
+    bool m_stopped;
+    const std::vector<SearchWorker*>* m_workers;
+    SearchResult m_result;
+    std::array<std::array<Move, max_ply + 1>, max_ply + 1> m_pv;
+    std::array<int, max_ply + 1> m_pv_length;
+    HistoryTable m_history;
+    std::array<std::array<Move, 2>, max_ply + 1> m_killers;
+    /// Quiet move that last refuted each move, indexed by its source and destiny.
+    std::array<std::array<Move, 64>, 64> m_countermoves;
+    /// Move made at each ply of the current line, a null move at the root.
+    std::array<Move, max_ply + 1> m_move_stack;
+
+    int negamax(int alpha, int beta, int depth, int ply);
+    int quiescence(int alpha, int beta, int ply);
+
+    /**
+     * @brief Rewards a quiet move that caused a beta cutoff and penalizes the quiet moves searched before it.
+     */
+    void updateQuietStats(Move move, int ply, int depth, const MoveList& tried_quiets);
+    void updatePv(int ply, Move move);
+
+    /**
+     * @brief Returns whether the search must be abandoned.
+     * @details Only the main worker checks the time and node limits, and raises the shared stop flag for everyone.
+     */
+    bool shouldStop();
+
+    /**
+     * @brief Returns whether a helper worker skips the given iteration of the iterative deepening.
+     */
+    bool skipsDepth(int depth) const;
+
+public:
+    /**
+     * @param id 0 for the main worker, which enforces the limits, or the index of a helper.
+     */
+    SearchWorker(TranspositionTable& table, std::atomic<bool>& stop, int id);
+
+    /**
+     * @brief Runs the iterative deepening on a copy of the given position until the limits or the stop flag end it.
+     * @details The node counters of every worker must be reset before any of them starts.
+     * @param workers Every worker of the search, used by the main worker to count the total nodes.
+     * @param on_iteration Called by the main worker with its result, counting the nodes of every worker, after each
+     *                     iteration. May be empty.
+     */
+    void search(const GameState& state, const SearchLimits& limits, std::chrono::steady_clock::time_point start_time,
+        const std::vector<SearchWorker*>& workers, const IterationCallback& on_iteration);
+
+    const SearchResult& getResult() const;
+    std::uint64_t getNodes() const;
+    void resetNodes();
+};
@@ -0,0 +1,180 @@
+#pragma once
+#include "../model/GameState.hpp"
+#include "../io/MappedFile.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief The pieces of an endgame, in the order in which their squares make up the index of a position.
+ * @details The order is the white king, the black king, the other white pieces and the other black pieces, each side
+ *          sorted like its name (queens, rooks, bishops, knights, pawns). The index of a position is the side to move
+ *          plus twice the squares of the pieces read as a number in base 64, the first piece being the lowest digit.
+ *          When a side has several pieces of a type, only the placements with their squares in increasing order are
+ *          used.
+ */
+class EndgameMaterial {
+public:
+    static constexpr int max_pieces = 4;
+
+private:
+    /// (color << 3) | type of each piece, like CompactPosition.
+    std::array<std::uint8_t, max_pieces> m_codes;
+    int m_size;
+
+public:
+    /**
+     * @brief Parses a name like "KQKR", where the first side is white. Throws std::invalid_argument if the name is not
+     *        two sides starting with a king or has more than max_pieces pieces.
+     */
+    static EndgameMaterial fromName(std::string_view name);
+
+    /**
+     * @brief Returns the key identifying the material on a board, with the colors swapped if flipped.
+     */
+    static std::uint64_t keyOf(const Board& board, bool flipped);
+
+    std::string getName() const;
+    int size() const;
+    PieceColor colorAt(int piece) const;
+    PieceType typeAt(int piece) const;
+
+    /**
+     * @brief Returns the key of the material, equal to keyOf for boards with exactly these pieces.
+     */
+    std::uint64_t key() const;
+
+    /**
+     * @brief Returns the number of indices, including those of impossible placements.
+     */
+    std::uint64_t positions() const;
+
+    /**
+     * @brief Returns true if the colors are in canonical order: white has the stronger side, which is the one tables
+     *        are generated for.
+     */
+    bool isCanonical() const;
+
+    /**
+     * @brief Returns the same material with the colors swapped.
+     */
+    EndgameMaterial flipped() const;
+
+    /**
+     * @brief Returns true if neither side has enough material to mate: no pieces besides the kings, or a lone minor
+     *        piece.
+     */
+    bool isTrivialDraw() const;
+
+    /**
+     * @brief Returns the index of a position with this material. If flipped, the board is mirrored vertically with the
+     *        colors swapped first, which keeps the value of the position.
+     */
+    std::uint64_t indexOf(const Board& board, PieceColor turn_color, bool flipped) const;
+
+    /**
+     * @brief Returns the index of the given squares, which must be in canonical order, and side to move.
+     */
+    std::uint64_t indexOf(const std::array<int, max_pieces>& squares, PieceColor turn_color) const;
+
+    /**
+     * @brief Splits an index into the squares of the pieces and the side to move.
+     */
+    void decode(std::uint64_t index, std::array<int, max_pieces>& squares, PieceColor& turn_color) const;
+};
+
+enum class TablebaseOutcome {
+    Loss = -1,
+    Draw = 0,
+    Win = 1
+};
+
+struct TablebaseResult {
+    /// Outcome for the player to move, with perfect play and without the fifty-move rule.
+    TablebaseOutcome outcome;
+    /// Plies until the mate, or 0 for draws.
+    int plies_to_mate;
+};
+
+/**
+ * @brief Distance to mate of every position of an endgame, stored in a memory-mapped file.
+ * @details The file is a 32 byte header followed by one entry per index of the EndgameMaterial, packed in as few bits
+ *          as the longest mate needs. An entry is 0 for draws and impossible placements, and otherwise 1 plus the plies
+ *          to mate: odd distances are wins for the player to move and even ones are losses.
+ *
+ *          Positions with castling rights or an en passant capture are not covered.
+ */
+class Tablebase {
+public:
+    static constexpr std::size_t header_size = 32;
+
+private:
+    MappedFile m_file;
+    EndgameMaterial m_material;
+    int m_bits;
+
+public:
+    /**
+     * @brief Maps the table at the given path. Throws std::runtime_error if it cannot be opened or is not a table.
+     */
+    explicit Tablebase(const std::string& path);
+
+    const EndgameMaterial& getMaterial() const;
+
+    /**
+     * @brief Returns the entry of an index, as described in the class.
+     */
+    int entry(std::uint64_t index) const;
+
+    /**
+     * @brief Converts an entry into the result it stands for.
+     */
+    static TablebaseResult resultOf(int entry);
+
+    /**
+     * @brief Writes entries as a table file. Throws std::runtime_error if the file cannot be written.
+     */
+    static void write(const std::string& path, const EndgameMaterial& material, const std::vector<std::uint16_t>& entries);
+};
+
+/**
+ * @brief The tablebases available to the program, probed by material.
+ */
+class Tablebases {
+private:
+    struct Lookup {
+        const Tablebase* table;
+        bool flipped;
+    };
+
+    std::vector<std::unique_ptr<Tablebase>> m_tables;
+    std::unordered_map<std::uint64_t, Lookup> m_by_key;
+
+public:
+    /// Extension of table files.
+    static constexpr const char* extension = ".tb";
+
+    /**
+     * @brief Maps the table at the given path. Throws std::runtime_error if it cannot be opened.
+     */
+    void add(const std::string& path);
+
+    /**
+     * @brief Maps every table in a directory and returns how many were found. Throws std::runtime_error if the
+     *        directory cannot be read.
+     */
+    int addDirectory(const std::string& directory);
+
+    bool contains(const EndgameMaterial& material) const;
+
+    /**
+     * @brief Returns the result of the position, or nullopt if no table covers it.
+     * @details Costs a hash lookup of the material and one read from the mapped table, and does not allocate.
+     */
+    std::optional<TablebaseResult> probe(const GameState& state) const;
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include "../model/Move.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief Fixed-size cache of search results keyed by the position hash.
+ * @details The table holds a power of two number of 64-byte buckets of four entries, so a probe touches a single cache
+ *          line. When a bucket is full, the entry with the lowest depth, counting older searches as shallower, is
+ *          replaced.
+ *
+ *          The table is shared by every search thread without locks. Each entry stores its key XORed with its data, so
+ *          an entry torn by two threads writing at once no longer matches its key and is ignored by probes.
+ */
+class TranspositionTable {
+public:
+    enum Bound : std::uint8_t {
+        None = 0,
+        /// The score is at most the stored one (no move raised alpha).
+        Upper = 1,
+        /// The score is at least the stored one (a move caused a beta cutoff).
+        Lower = 2,
+        Exact = 3
+    };
+
+    struct Entry {
+        Move move;
+        int score;
+        int depth;
+        Bound bound;
+    };
+
+private:
+    struct Slot {
+        /// The position hash XORed with data.
+        std::atomic<std::uint64_t> key;
+        /// Packs the move (16 bits), score (16 bits), depth (8 bits), bound (2 bits) and generation (6 bits).
+        std::atomic<std::uint64_t> data;
+    };
+
+    struct alignas(64) Bucket {
+        std::array<Slot, 4> slots;
+    };
+
+    std::unique_ptr<Bucket[]> m_buckets;
+    std::size_t m_size;
+    std::uint64_t m_mask;
+    std::uint8_t m_generation;
+
+    static std::uint64_t pack(Move move, int score, int depth, Bound bound, std::uint8_t generation);
+    static Entry unpack(std::uint64_t data);
+    static std::uint8_t generationOf(std::uint64_t data);
+    static int depthOf(std::uint64_t data);
+
+public:
+    explicit TranspositionTable(std::size_t megabytes);
+
+    /**
+     * @brief Reallocates the table with the largest power of two number of buckets that fits in the given size.
+     */
+    void resize(std::size_t megabytes);
+    void clear();
+
+    /**
+     * @brief Marks the start of a new search, so entries from earlier searches are replaced first.
+     * @details Must not be called while a search is running.
+     */
+    void newSearch();
+
+    /**
+     * @brief Looks up a position. Safe to call from several threads at once, as is store.
+     */
+    bool probe(std::uint64_t key, Entry& entry) const;
+    void store(std::uint64_t key, Move move, int score, int depth, Bound bound);
+
+    /**
+     * @brief Returns how full the table is in permille, sampled from the first buckets.
+     */
+    int hashfull() const;
+};
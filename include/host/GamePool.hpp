@@ -0,0 +1,81 @@
+#pragma once
+#include "../model/CompactPosition.hpp"
+#include "../model/GameState.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using GameId = std::uint32_t;
+
+/// A move sent to one of the games of a GamePool.
+struct MoveRequest {
+    GameId game;
+    /// Squares indexed like the bitboards, from a1 = 0 to h8 = 63.
+    std::uint8_t from;
+    std::uint8_t to;
+    /// The piece a pawn reaching the last row promotes to.
+    PieceType promotion = PieceType::Queen;
+};
+
+/**
+ * @brief Holds a large number of games as CompactPositions in slots reused by integer ID.
+ * @details Creating and destroying a game is O(1): destroyed IDs go to a free list and are handed out again before the
+ *          storage grows. A game is expanded into a GameState only while a move is being validated and played on it.
+ *
+ *          Games must not be created or destroyed while applyMoves runs.
+ */
+class GamePool {
+private:
+    std::vector<CompactPosition> m_positions;
+    std::vector<std::uint8_t> m_in_use;
+    std::vector<GameId> m_free_ids;
+
+    /**
+     * @brief Plays the requests with the given indices, in order, on the games they refer to.
+     */
+    void applyShard(const std::vector<MoveRequest>& requests, const std::vector<std::size_t>& indices,
+        std::vector<std::uint8_t>& results);
+
+public:
+    void reserve(std::size_t games);
+
+    /**
+     * @brief Creates a game at the starting position and returns its ID.
+     */
+    GameId create();
+    GameId create(const GameState& state);
+
+    /**
+     * @brief Frees the slot of a game so that its ID can be reused. Throws std::out_of_range if the game does not exist.
+     */
+    void destroy(GameId id);
+    bool contains(GameId id) const;
+
+    /**
+     * @brief Returns the number of live games.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Returns the game expanded into a GameState. Throws std::out_of_range if the game does not exist.
+     */
+    GameState load(GameId id) const;
+
+    /**
+     * @brief Replaces the position of a game. Throws std::out_of_range if the game does not exist.
+     */
+    void store(GameId id, const GameState& state);
+
+    /**
+     * @brief Validates and plays a batch of moves.
+     * @details Games are sharded over the threads by ID, so the requests of one game are played by one thread in the
+     *          order of the batch.
+     * @return For each request, 1 if the move was legal and played, or 0 if it was rejected or the game does not exist.
+     */
+    std::vector<std::uint8_t> applyMoves(const std::vector<MoveRequest>& requests, int threads = 1);
+
+    /**
+     * @brief Returns the bytes allocated by the pool.
+     */
+    std::size_t memoryUsage() const;
+};
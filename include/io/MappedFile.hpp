@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief A file mapped read-only into memory for as long as the object lives.
+ * @details Uses mmap, or a file mapping on Windows. The pages are shared by every process that maps the same file and
+ *          are only read from disk when touched.
+ */
+class MappedFile {
+private:
+    const unsigned char* m_data;
+    std::size_t m_size;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#endif
+
+    void unmap();
+
+public:
+    /**
+     * @brief Maps the file at the given path. Throws std::runtime_error if it cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::string& path);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    /**
+     * @brief Returns the contents of the file, or nullptr if it is empty.
+     */
+    const unsigned char* data() const;
+    std::size_t size() const;
+};
+
+inline const unsigned char* MappedFile::data() const
+{
+    return m_data;
+}
+
+inline std::size_t MappedFile::size() const
+{
+    return m_size;
+}
@@ -0,0 +1,320 @@
+#pragma once
+#include "Bitboard.hpp"
+#include "PieceColor.hpp"
+#include "PieceType.hpp"
+#include "Square.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#if defined(CHESS_USE_PEXT)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Attack sets of every piece type, computed set-wise from precomputed tables.
+ * @details Rook and bishop attacks come from magic bitboard tables: the occupancy of the squares that can block the
+ *          slider is hashed into an index of a table holding every possible attack set of the square. When built with
+ *          CHESS_USE_PEXT the index is extracted with the BMI2 PEXT instruction instead of a magic multiplication. All
+ *          the tables, the attack sets of the sliders included, are computed by the compiler.
+ */
+namespace Attacks {
+    enum Direction {
+        North = 0,
+        East = 1,
+        NorthEast = 2,
+        NorthWest = 3,
+        South = 4,
+        West = 5,
+        SouthWest = 6,
+        SouthEast = 7
+    };
+
+    /// Where to find the attacks of a slider on one square.
+    struct Magic {
+        /// Squares whose occupancy changes the attacks, which are the rays without their last square.
+        Bitboard mask;
+        Bitboard magic;
+        /// Index in Tables::slider_attacks of the first of the 2^popCount(mask) attack sets of the square.
+        unsigned offset;
+        unsigned shift;
+
+        unsigned index(Bitboard occupied) const
+        {
+#if defined(CHESS_USE_PEXT)
+            return static_cast<unsigned>(_pext_u64(occupied, mask));
+#else
+            return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+#endif
+        }
+    };
+
+    /// constexpr builders of the tables that do not depend on the occupancy, evaluated by the compiler.
+    namespace Generation {
+        struct Offset {
+            int col;
+            int row;
+        };
+
+        /// Step of every Direction, in the same order.
+        constexpr std::array<Offset, 8> direction_offsets = { { { 0, 1 }, { 1, 0 }, { 1, 1 }, { -1, 1 }, { 0, -1 }, { -1, 0 }, { -1, -1 }, { 1, -1 } } };
+        constexpr std::array<Offset, 8> knight_offsets = { { { -2, -1 }, { -1, -2 }, { -1, 2 }, { 2, -1 }, { 1, 2 }, { 2, 1 }, { 1, -2 }, { -2, 1 } } };
+        constexpr std::array<Offset, 2> white_pawn_offsets = { { { -1, 1 }, { 1, 1 } } };
+        constexpr std::array<Offset, 2> black_pawn_offsets = { { { -1, -1 }, { 1, -1 } } };
+
+        /**
+         * @brief Returns, for every square, the squares one of the offsets away from it.
+         */
+        template <std::size_t size>
+        constexpr std::array<Bitboard, 64> leaperAttacks(const std::array<Offset, size>& offsets)
+        {
+            std::array<Bitboard, 64> attacks {};
+            for (int square = 0; square < 64; square++) {
+                for (const Offset& offset : offsets) {
+                    const int col = Bitboards::columnOf(square) + offset.col;
+                    const int row = Bitboards::rowOf(square) + offset.row;
+                    if (Square::isOnBoard(col, row)) {
+                        attacks[square] |= Bitboards::squareBit(Bitboards::squareOf(col, row));
+                    }
+                }
+            }
+            return attacks;
+        }
+
+        constexpr std::array<std::array<Bitboard, 64>, 8> rays()
+        {
+            std::array<std::array<Bitboard, 64>, 8> rays {};
+            for (int direction = 0; direction < 8; direction++) {
+                const Offset step = direction_offsets[direction];
+                for (int square = 0; square < 64; square++) {
+                    for (int col = Bitboards::columnOf(square) + step.col, row = Bitboards::rowOf(square) + step.row;
+                         Square::isOnBoard(col, row); col += step.col, row += step.row) {
+                        rays[direction][square] |= Bitboards::squareBit(Bitboards::squareOf(col, row));
+                    }
+                }
+            }
+            return rays;
+        }
+
+        constexpr std::array<std::array<Bitboard, 64>, 64> between(const std::array<std::array<Bitboard, 64>, 8>& rays)
+        {
+            std::array<std::array<Bitboard, 64>, 64> between {};
+            for (int source = 0; source < 64; source++) {
+                for (int direction = 0; direction < 8; direction++) {
+                    const int opposite = (direction + 4) % 8;
+                    for (int destiny = 0; destiny < 64; destiny++) {
+                        if (rays[direction][source] & Bitboards::squareBit(destiny)) {
+                            between[source][destiny] = rays[direction][source] & rays[opposite][destiny];
+                        }
+                    }
+                }
+            }
+            return between;
+        }
+
+        constexpr std::array<std::array<Bitboard, 64>, 64> line(const std::array<std::array<Bitboard, 64>, 8>& rays)
+        {
+            std::array<std::array<Bitboard, 64>, 64> line {};
+            for (int source = 0; source < 64; source++) {
+                for (int direction = 0; direction < 8; direction++) {
+                    const Bitboard whole_line = rays[direction][source] | rays[(direction + 4) % 8][source] | Bitboards::squareBit(source);
+                    for (int destiny = 0; destiny < 64; destiny++) {
+                        if (rays[direction][source] & Bitboards::squareBit(destiny)) {
+                            line[source][destiny] = whole_line;
+                        }
+                    }
+                }
+            }
+            return line;
+        }
+
+        constexpr std::array<std::array<std::uint8_t, 64>, 64> distance()
+        {
+            std::array<std::array<std::uint8_t, 64>, 64> distance {};
+            for (int source = 0; source < 64; source++) {
+                for (int destiny = 0; destiny < 64; destiny++) {
+                    const int cols = Bitboards::columnOf(source) - Bitboards::columnOf(destiny);
+                    const int rows = Bitboards::rowOf(source) - Bitboards::rowOf(destiny);
+                    const int col_distance = cols < 0 ? -cols : cols;
+                    const int row_distance = rows < 0 ? -rows : rows;
+                    distance[source][destiny] = static_cast<std::uint8_t>(col_distance > row_distance ? col_distance : row_distance);
+                }
+            }
+            return distance;
+        }
+
+        constexpr std::array<Direction, 4> rook_directions = { North, East, South, West };
+        constexpr std::array<Direction, 4> bishop_directions = { NorthEast, NorthWest, SouthEast, SouthWest };
+
+        /// Magic numbers of every square, found once by trial and error. PEXT does not use them.
+        constexpr std::array<Bitboard, 64> rook_magic_numbers = {
+            0x0A80004000801220, 0x8040004010002008, 0x2080200010008008, 0x1100100008210004,
+            0xC200209084020008, 0x2100010004000208, 0x0400081000822421, 0x0200010422048844,
+            0x0800800080400024, 0x0001402000401000, 0x3000801000802001, 0x4400800800100083,
+            0x0904802402480080, 0x4040800400020080, 0x0018808042000100, 0x4040800080004100,
+            0x0040048001458024, 0x00A0004000205000, 0x3100808010002000, 0x4825010010000820,
+            0x5004808008000401, 0x2024818004000A00, 0x0005808002000100, 0x2100060004806104,
+            0x0080400880008421, 0x4062220600410280, 0x010A004A00108022, 0x0000100080080080,
+            0x0021000500080010, 0x0044000202001008, 0x0000100400080102, 0xC020128200040545,
+            0x0080002000400040, 0x0000804000802004, 0x0000120022004080, 0x010A386103001001,
+            0x9010080080800400, 0x8440020080800400, 0x0004228824001001, 0x000000490A000084,
+            0x0080002000504000, 0x200020005000C000, 0x0012088020420010, 0x0010010080080800,
+            0x0085001008010004, 0x0002000204008080, 0x0040413002040008, 0x0000304081020004,
+            0x0080204000800080, 0x3008804000290100, 0x1010100080200080, 0x2008100208028080,
+            0x5000850800910100, 0x8402019004680200, 0x0120911028020400, 0x0000008044010200,
+            0x0020850200244012, 0x0020850200244012, 0x0000102001040841, 0x140900040A100021,
+            0x000200282410A102, 0x000200282410A102, 0x000200282410A102, 0x4048240043802106
+        };
+        constexpr std::array<Bitboard, 64> bishop_magic_numbers = {
+            0x40106000A1160020, 0x0020010250810120, 0x2010010220280081, 0x002806004050C040,
+            0x0002021018000000, 0x2001112010000400, 0x0881010120218080, 0x1030820110010500,
+            0x0000120222042400, 0x2000020404040044, 0x8000480094208000, 0x0003422A02000001,
+            0x000A220210100040, 0x8004820202226000, 0x0018234854100800, 0x0100004042101040,
+            0x0004001004082820, 0x0010000810010048, 0x1014004208081300, 0x2080818802044202,
+            0x0040880C00A00100, 0x0080400200522010, 0x0001000188180B04, 0x0080249202020204,
+            0x1004400004100410, 0x00013100A0022206, 0x2148500001040080, 0x4241080011004300,
+            0x4020848004002000, 0x10101380D1004100, 0x0008004422020284, 0x01010A1041008080,
+            0x0808080400082121, 0x0808080400082121, 0x0091128200100C00, 0x0202200802010104,
+            0x8C0A020200440085, 0x01A0008080B10040, 0x0889520080122800, 0x100902022202010A,
+            0x04081A0816002000, 0x0000681208005000, 0x8170840041008802, 0x0A00004200810805,
+            0x0830404408210100, 0x2602208106006102, 0x1048300680802628, 0x2602208106006102,
+            0x0602010120110040, 0x0941010801043000, 0x000040440A210428, 0x0008240020880021,
+            0x0400002012048200, 0x00AC102001210220, 0x0220021002009900, 0x84440C080A013080,
+            0x0001008044200440, 0x0004C04410841000, 0x2000500104011130, 0x1A0C010011C20229,
+            0x0044800112202200, 0x0434804908100424, 0x0300404822C08200, 0x48081010008A2A80
+        };
+
+        constexpr int bitCount(Bitboard bitboard)
+        {
+            int count = 0;
+            for (; bitboard != 0; bitboard &= bitboard - 1) {
+                count++;
+            }
+            return count;
+        }
+
+        /**
+         * @brief Returns the Magic entries of a slider, whose attack sets are laid out one square after the other from
+         *        first_offset on.
+         */
+        constexpr std::array<Magic, 64> magics(const std::array<std::array<Bitboard, 64>, 8>& rays, const std::array<Direction, 4>& directions,
+            const std::array<Bitboard, 64>& magic_numbers, unsigned first_offset)
+        {
+            constexpr Bitboard first_row = 0xFFULL;
+            constexpr Bitboard first_column = 0x0101010101010101ULL;
+            std::array<Magic, 64> magics {};
+            unsigned offset = first_offset;
+            for (int square = 0; square < 64; square++) {
+                // The last square of a ray is attacked whether or not it is occupied.
+                const Bitboard row = first_row << (8 * (Bitboards::rowOf(square) - 1));
+                const Bitboard column = first_column << (Bitboards::columnOf(square) - 1);
+                const Bitboard edges = (((first_row | first_row << 56) & ~row) | ((first_column | first_column << 7) & ~column));
+                Bitboard mask = 0;
+                for (Direction direction : directions) {
+                    mask |= rays[direction][square];
+                }
+                mask &= ~edges;
+                const int bits = bitCount(mask);
+                magics[square] = { mask, magic_numbers[square], offset, static_cast<unsigned>(64 - bits) };
+                offset += 1U << bits;
+            }
+            return magics;
+        }
+    }
+
+    /**
+     * @brief The lookup tables, all constants built at compile time, so they need no initialization and are shared
+     *        read-only by every thread.
+     */
+    namespace Tables {
+        inline constexpr std::array<Bitboard, 64> knight = Generation::leaperAttacks(Generation::knight_offsets);
+        inline constexpr std::array<Bitboard, 64> king = Generation::leaperAttacks(Generation::direction_offsets);
+        inline constexpr std::array<std::array<Bitboard, 64>, 2> pawn = { Generation::leaperAttacks(Generation::white_pawn_offsets),
+            Generation::leaperAttacks(Generation::black_pawn_offsets) };
+        inline constexpr std::array<std::array<Bitboard, 64>, 8> rays = Generation::rays();
+        inline constexpr std::array<std::array<Bitboard, 64>, 64> between = Generation::between(rays);
+        inline constexpr std::array<std::array<Bitboard, 64>, 64> line = Generation::line(rays);
+        inline constexpr std::array<std::array<std::uint8_t, 64>, 64> distance = Generation::distance();
+        inline constexpr std::array<Magic, 64> rook_magics = Generation::magics(rays, Generation::rook_directions, Generation::rook_magic_numbers, 0);
+        inline constexpr std::array<Magic, 64> bishop_magics = Generation::magics(rays, Generation::bishop_directions,
+            Generation::bishop_magic_numbers, rook_magics[63].offset + (1U << (64 - rook_magics[63].shift)));
+        inline constexpr std::size_t slider_attacks_size = bishop_magics[63].offset + (1U << (64 - bishop_magics[63].shift));
+
+        /// Attack sets of the rook and bishop on every square for every occupancy, split between the squares by the
+        /// Magic entries. Built by the compiler in Attacks.cpp, so it is constant initialized like the other tables.
+        extern const std::array<Bitboard, slider_attacks_size> slider_attacks;
+    }
+
+    constexpr Bitboard knight(int square)
+    {
+        return Tables::knight[square];
+    }
+
+    constexpr Bitboard king(int square)
+    {
+        return Tables::king[square];
+    }
+
+    /**
+     * @brief Returns the squares a pawn of the given color standing on the square attacks.
+     */
+    constexpr Bitboard pawn(PieceColor color, int square)
+    {
+        return Tables::pawn[static_cast<int>(color)][square];
+    }
+
+    /**
+     * @brief Returns the squares along a ray up to and including the first occupied square.
+     * @details Slower than the magic lookups of rook and bishop, which are built from it.
+     */
+    constexpr Bitboard ray(Direction direction, int square, Bitboard occupied)
+    {
+        const Bitboard attacks = Tables::rays[direction][square];
+        const Bitboard blockers = attacks & occupied;
+        if (blockers == Bitboards::Empty) {
+            return attacks;
+        }
+        const int blocker = direction < South ? Bitboards::lsb(blockers) : Bitboards::msb(blockers);
+        return attacks ^ Tables::rays[direction][blocker];
+    }
+
+    inline Bitboard rook(int square, Bitboard occupied)
+    {
+        const Magic& magic = Tables::rook_magics[square];
+        return Tables::slider_attacks[magic.offset + magic.index(occupied)];
+    }
+
+    inline Bitboard bishop(int square, Bitboard occupied)
+    {
+        const Magic& magic = Tables::bishop_magics[square];
+        return Tables::slider_attacks[magic.offset + magic.index(occupied)];
+    }
+
+    inline Bitboard queen(int square, Bitboard occupied)
+    {
+        return rook(square, occupied) | bishop(square, occupied);
+    }
+
+    /**
+     * @brief Returns the squares strictly between two squares sharing a column, row or diagonal, or an empty set.
+     */
+    constexpr Bitboard between(int source, int destiny)
+    {
+        return Tables::between[source][destiny];
+    }
+
+    /**
+     * @brief Returns the whole column, row or diagonal through two squares, or an empty set if they are not aligned.
+     */
+    constexpr Bitboard line(int source, int destiny)
+    {
+        return Tables::line[source][destiny];
+    }
+
+    /**
+     * @brief Returns the number of king moves between two squares on an empty board.
+     */
+    constexpr int distance(int source, int destiny)
+    {
+        return Tables::distance[source][destiny];
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * @brief A set of squares, one bit per square.
+ * @details Squares are indexed little-endian rank-file: a1 is 0, b1 is 1, ..., h1 is 7, a2 is 8, ..., h8 is 63.
+ */
+using Bitboard = std::uint64_t;
+
+namespace Bitboards {
+    constexpr Bitboard Empty = 0;
+
+    constexpr int squareOf(int col, int row)
+    {
+        return (row - 1) * 8 + (col - 1);
+    }
+
+    constexpr int columnOf(int square)
+    {
+        return square % 8 + 1;
+    }
+
+    constexpr int rowOf(int square)
+    {
+        return square / 8 + 1;
+    }
+
+    constexpr Bitboard squareBit(int square)
+    {
+        return Bitboard(1) << square;
+    }
+
+    constexpr int lsb(Bitboard bitboard)
+    {
+        return __builtin_ctzll(bitboard);
+    }
+
+    constexpr int msb(Bitboard bitboard)
+    {
+        return 63 - __builtin_clzll(bitboard);
+    }
+
+    constexpr int popLsb(Bitboard& bitboard)
+    {
+        const int square = lsb(bitboard);
+        bitboard &= bitboard - 1;
+        return square;
+    }
+
+    constexpr int popCount(Bitboard bitboard)
+    {
+        return __builtin_popcountll(bitboard);
+    }
+}
@@ -1,17 +1,147 @@
 #pragma once
+#include "Bitboard.hpp"
 #include "BoardCoordinate.hpp"
 #include "Piece.hpp"
 #include <array>
 #include <optional>
 
+/**
+ * @brief Piece placement stored as bitboards, with a mailbox for piece-on-square lookups.
+ * @details Keeps one bitboard per piece type and per color, plus the union of both colors. The mailbox holds the
+ *          piece on every square (including whether it has moved), indexed like the bitboards.
+ */
 class Board {
+public:
+    /**
+     * @brief Compatibility handle returned by accessBoard.
+     * @details Behaves like a reference to the optional piece on a square, but writes go through the board so that the
+     *          bitboards are kept in sync with the mailbox.
+     */
+    class SquareReference {
+    private:
+        /// Gives access to the piece and resynchronizes the square's bitboards once the expression ends.
+        class PieceHandle {
+        private:
+            Board& m_board;
+            int m_square;
+
+        public:
+            PieceHandle(Board& board, int square);
+            PieceHandle(const PieceHandle&) = delete;
+            PieceHandle& operator=(const PieceHandle&) = delete;
+            ~PieceHandle();
+            Piece* operator->() const;
+        };
+
+        Board& m_board;
+        int m_square;
+
+    public:
+        SquareReference(Board& board, int square);
+        SquareReference& operator=(const SquareReference& that);
+        SquareReference& operator=(const std::optional<Piece>& piece);
+        void reset();
+        bool has_value() const;
+        explicit operator bool() const;
+        operator std::optional<Piece>() const;
+        PieceHandle operator->() const;
+    };
+
 private:
-    std::array<std::optional<Piece>, 64> m_board;
+    std::array<Bitboard, 6> m_pieces_by_type;
+    std::array<Bitboard, 2> m_pieces_by_color;
+    Bitboard m_occupied;
+    std::array<std::optional<Piece>, 64> m_mailbox;
+
+    void resyncSquare(int square);
 
 public:
     Board();
-    std::optional<Piece>& accessBoard(const BoardCoordinate pos);
-    std::optional<Piece>& accessBoard(short int col, short int row);
+    void clear();
+    SquareReference accessBoard(const BoardCoordinate pos);
+    SquareReference accessBoard(short int col, short int row);
     std::optional<Piece> readBoard(const BoardCoordinate pos) const;
     std::optional<Piece> readBoard(short int col, short int row) const;
+
+    const std::optional<Piece>& pieceAt(int square) const;
+    bool isOccupied(int square) const;
+    Bitboard occupied() const;
+    Bitboard pieces(PieceColor color) const;
+    Bitboard pieces(PieceType type) const;
+    Bitboard pieces(PieceColor color, PieceType type) const;
+
+    /**
+     * @brief Places a piece on an empty square.
+     */
+    void putPiece(int square, const Piece& piece);
+
+    /**
+     * @brief Removes the piece on an occupied square.
+     */
+    void removePiece(int square);
+
+    /**
+     * @brief Moves the piece on an occupied square to an empty square.
+     */
+    void movePiece(int from, int to);
 };
+
+inline const std::optional<Piece>& Board::pieceAt(int square) const
+{
+    return m_mailbox[square];
+}
+
+inline bool Board::isOccupied(int square) const
+{
+    return m_occupied & Bitboards::squareBit(square);
+}
+
+inline Bitboard Board::occupied() const
+{
+    return m_occupied;
+}
+
+inline Bitboard Board::pieces(PieceColor color) const
+{
+    return m_pieces_by_color[static_cast<int>(color)];
+}
+
+inline Bitboard Board::pieces(PieceType type) const
+{
+    return m_pieces_by_type[static_cast<int>(type)];
+}
+
+inline Bitboard Board::pieces(PieceColor color, PieceType type) const
+{
+    return m_pieces_by_color[static_cast<int>(color)] & m_pieces_by_type[static_cast<int>(type)];
+}
+
+inline void Board::putPiece(int square, const Piece& piece)
+{
+    const Bitboard bit = Bitboards::squareBit(square);
+    m_pieces_by_type[static_cast<int>(piece.getType())] |= bit;
+    m_pieces_by_color[static_cast<int>(piece.getColor())] |= bit;
+    m_occupied |= bit;
+    m_mailbox[square] = piece;
+}
+
+inline void Board::removePiece(int square)
+{
+    const Bitboard bit = Bitboards::squareBit(square);
+    const Piece& piece = *m_mailbox[square];
+    m_pieces_by_type[static_cast<int>(piece.getType())] ^= bit;
+    m_pieces_by_color[static_cast<int>(piece.getColor())] ^= bit;
+    m_occupied ^= bit;
+    m_mailbox[square].reset();
+}
+
+inline void Board::movePiece(int from, int to)
+{
+    const Bitboard bits = Bitboards::squareBit(from) | Bitboards::squareBit(to);
+    const Piece& piece = *m_mailbox[from];
+    m_pieces_by_type[static_cast<int>(piece.getType())] ^= bits;
+    m_pieces_by_color[static_cast<int>(piece.getColor())] ^= bits;
+    m_occupied ^= bits;
+    m_mailbox[to] = m_mailbox[from];
+    m_mailbox[from].reset();
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include "Square.hpp"
 
 namespace BoardColumn {
     constexpr int A = 1;
@@ -16,9 +17,48 @@ private:
     int m_column;
     int m_row;
 
+    /// Kept out of line so that the checked constructor inlines to a comparison.
+    [[noreturn]] static void throwOutOfBoard(int column, int row);
+
 public:
-    BoardCoordinate(int column, int row);
-    int getCol() const;
-    int getRow() const;
-    bool operator==(const BoardCoordinate& that);
+    /**
+     * @brief Throws std::out_of_range if the column or the row is not between 1 and 8.
+     */
+    constexpr BoardCoordinate(int column, int row)
+        : m_column(column)
+        , m_row(row)
+    {
+        if (!Square::isOnBoard(column, row)) {
+            throwOutOfBoard(column, row);
+        }
+    }
+
+    /**
+     * @brief Converts a square, which is always on the board, so it cannot throw.
+     */
+    constexpr explicit BoardCoordinate(Square square)
+        : m_column(square.getCol())
+        , m_row(square.getRow())
+    {
+    }
+
+    constexpr int getCol() const
+    {
+        return m_column;
+    }
+
+    constexpr int getRow() const
+    {
+        return m_row;
+    }
+
+    constexpr Square toSquare() const
+    {
+        return Square::at(m_column, m_row);
+    }
+
+    constexpr bool operator==(const BoardCoordinate& that) const
+    {
+        return m_column == that.m_column && m_row == that.m_row;
+    }
 };
@@ -0,0 +1,24 @@
+#pragma once
+#include "Bitboard.hpp"
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief A position packed into 32 bytes, for keeping many games in memory at once.
+ * @details Holds what the rules need to continue the game, like a FEN string does: whether kings and rooks have moved
+ *          follows from the castling rights, and whether pawns have moved from their row. The repetition history is
+ *          not kept. Built with GameState::toCompact and expanded with GameState::loadCompact.
+ */
+struct CompactPosition {
+    Bitboard occupied;
+    /// A 4-bit code per piece, (color << 3) | type, two per byte, in the order of the squares of occupied from a1 to h8.
+    std::array<std::uint8_t, 16> pieces;
+    std::uint16_t halfmove_clock;
+    std::uint16_t fullmove_number;
+    /// Bit 0 is set when black is to move and bits 1 to 4 hold the CastlingRights mask.
+    std::uint8_t flags;
+    /// Column (1-8) of the pawn that can be captured en passant, or 0 if there is none.
+    std::uint8_t en_passant_column;
+};
+
+static_assert(sizeof(CompactPosition) <= 32, "CompactPosition must stay within half a cache line");
@@ -1,17 +1,85 @@
 #pragma once
 #include "Board.hpp"
 #include "BoardCoordinate.hpp"
+#include "CompactPosition.hpp"
+#include "Move.hpp"
+#include "MoveList.hpp"
 #include "Piece.hpp"
+#include "PieceSquareTables.hpp"
 #include <array>
+#include <cstdint>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace CastlingRights {
+    constexpr int None = 0;
+    constexpr int WhiteKingSide = 1;
+    constexpr int WhiteQueenSide = 2;
+    constexpr int BlackKingSide = 4;
+    constexpr int BlackQueenSide = 8;
+}
+
+/// Selects which legal moves are generated.
+enum class MoveGeneration {
+    All,
+    /// Captures, en passant and promotions.
+    Captures,
+    /// Every other move, including castling.
+    Quiets
+};
 
-/// TODO: Disable castling when a player's king is in check.
 class GameState {
+public:
+    /// Maximum number of moves made with makeMove that can be pending to be unmade.
+    static constexpr int max_undo_depth = 256;
+
 private:
+    /// What makeMove needs to remember so that unmakeMove can restore the position.
+    struct UndoRecord {
+        Move move;
+        bool moved_piece_had_moved;
+        std::optional<Piece> captured_piece;
+        std::optional<BoardCoordinate> pawn_double_moved_last_turn;
+        int castling_rights;
+        int halfmove_clock;
+        std::uint64_t hash;
+        TaperedScore piece_square_score;
+        int phase;
+    };
+
+    struct HistoryEntry {
+        std::uint64_t hash;
+        /// Number of earlier occurrences of the same position since the last capture or pawn move.
+        int repetitions;
+    };
+
     PieceColor m_turn_color;
     Board m_board;
-    std::optional<Piece> pawn_double_moved_last_turn;
-    std::optional<Piece>& accessBoard(short int col, short int row);
+    std::optional<BoardCoordinate> pawn_double_moved_last_turn;
+    int m_castling_rights;
+    std::uint64_t m_hash;
+    /// Sum of PieceSquare::value over the pieces on the board, updated incrementally by move.
+    TaperedScore m_piece_square_score;
+    /// Sum of the phase weights of the pieces on the board.
+    int m_phase;
+    int m_halfmove_clock;
+    int m_fullmove_number;
+    /// Number of changes made to the position, so views can tell whether it changed since they last looked.
+    std::uint64_t m_generation;
+    std::vector<HistoryEntry> m_history;
+    std::array<UndoRecord, max_undo_depth> m_undo_stack;
+    int m_undo_size;
+    /// Square of the king of each color, indexed by PieceColor.
+    std::array<int, 2> m_king_squares;
+
+    /// Whether m_checkers and m_pinned describe the current position. They are computed on first use after each move.
+    mutable bool m_check_info_valid;
+    /// Opposing pieces giving check to the king of the player to move.
+    mutable Bitboard m_checkers;
+    /// Pieces of the player to move that are the only blocker between their king and an opposing slider.
+    mutable Bitboard m_pinned;
 
     /**
      * @brief Returns true if there is interruptions between the source and the destiny.
@@ -27,10 +95,212 @@ private:
     bool belongsToCurrentPlayer(const Piece& piece) const;
     BoardCoordinate findKingPosition(PieceColor color) const;
 
+    /**
+     * @brief Computes the checkers and pinned pieces of the position unless they are already cached.
+     */
+    void updateCheckInfo() const;
+
+    /**
+     * @brief Derives the castling rights, king squares, hash and history from the board, side to move and en passant
+     *        pawn. Throws std::invalid_argument if a color does not have exactly one king.
+     */
+    void initializeDerivedState();
+
+    /**
+     * @brief Returns the pieces of the given color that attack a square, given an occupancy set.
+     */
+    Bitboard attackersTo(int square, PieceColor color, Bitboard occupied) const;
+    bool canCastle(PieceColor color, int rook_column) const;
+    int computeCastlingRights() const;
+
+    /**
+     * @brief Returns the squares the king of the player to move can castle to. The king must not be in check.
+     */
+    Bitboard castlingDestinations() const;
+
+    /**
+     * @brief Returns the en passant key included in the hash.
+     * @details The column of the double moved pawn only counts if a pawn of the player to move stands next to it, so
+     *          positions that only differ by an impossible en passant capture hash the same.
+     */
+    std::uint64_t enPassantKey() const;
+
+    /**
+     * @brief Appends the current position to the history, counting its earlier occurrences.
+     * @details Only positions with the same player to move since the last irreversible move can repeat, so at most
+     *          m_halfmove_clock / 2 entries are compared.
+     */
+    void pushHistory();
+    void applyMove(const Move move);
+
+    /// The microbenchmarks of chess_bench time some private primitives directly.
+    friend class ModelBenchmarks;
+
 public:
     GameState();
+
+    /**
+     * @brief Creates a game from an arbitrary position.
+     * @details Castling rights follow from whether the kings and rooks have moved.
+     * @param board The pieces on the board.
+     * @param turn_color The color of the player to move.
+     * @param double_moved_pawn The pawn that can be captured en passant, if any.
+     */
+    GameState(const Board& board, PieceColor turn_color, std::optional<BoardCoordinate> double_moved_pawn = std::nullopt);
+
+    /**
+     * @brief Creates a game from a position in Forsyth-Edwards Notation. See loadFEN.
+     */
+    static GameState fromFEN(std::string_view fen);
+
+    /**
+     * @brief Replaces the game with a position in Forsyth-Edwards Notation, reusing its storage.
+     * @details The castling field decides which kings and rooks count as not moved, and the en passant square sets the
+     *          pawn that can be captured en passant. The halfmove clock and fullmove number are optional and default to
+     *          0 and 1. Parsing does not allocate, so loading many positions into the same game is cheaper than
+     *          creating one with fromFEN for each. Throws std::invalid_argument, leaving the game unchanged, if the FEN
+     *          is malformed or describes an inconsistent position.
+     */
+    void loadFEN(std::string_view fen);
+
+    /**
+     * @brief Returns the position packed into a CompactPosition.
+     * @details Throws std::length_error if the board has more than 32 pieces, which no game can reach.
+     */
+    CompactPosition toCompact() const;
+
+    /**
+     * @brief Replaces the game with a position packed by toCompact, reusing its storage like loadFEN.
+     */
+    void loadCompact(const CompactPosition& position);
+
+    /**
+     * @brief Returns the position in Forsyth-Edwards Notation.
+     */
+    std::string toFEN() const;
     std::optional<Piece> readBoard(const BoardCoordinate pos) const;
     std::optional<Piece> readBoard(short int col, short int row) const;
+    PieceColor getTurnColor() const;
+    const Board& getBoard() const;
+
+    /**
+     * @brief Returns the pawn that moved two squares in the last move, which may be capturable en passant.
+     */
+    std::optional<BoardCoordinate> getDoubleMovedPawn() const;
+
+    /**
+     * @brief Returns a counter that changes whenever the position does: on every move, unmade move and loaded
+     *        position.
+     */
+    std::uint64_t getGeneration() const;
+
+    /**
+     * @brief Returns the castling rights as a CastlingRights mask.
+     * @details The rights are derived from whether the kings and rooks have moved and are cached until a move touches
+     *          one of their starting squares.
+     */
+    int castlingRights() const;
+
+    /**
+     * @brief Returns the Zobrist key of the position, which is updated incrementally by move.
+     */
+    std::uint64_t getHash() const;
+
+    /**
+     * @brief Computes the Zobrist key of the position from scratch.
+     */
+    std::uint64_t computeHash() const;
+
+    /**
+     * @brief Returns the material and piece-square score of the position from the point of view of white.
+     * @details The score is updated incrementally by move, so reading it costs nothing.
+     */
+    TaperedScore getPieceSquareScore() const;
+
+    /**
+     * @brief Computes the material and piece-square score of the position from scratch.
+     */
+    TaperedScore computePieceSquareScore() const;
+
+    /**
+     * @brief Returns the game phase, from PieceSquare::max_phase with all pieces on the board to 0 with only pawns and
+     *        kings. It exceeds PieceSquare::max_phase if promotions added pieces.
+     */
+    int getPhase() const;
+
+    /**
+     * @brief Returns the number of plies since the last capture or pawn move.
+     */
+    int getHalfmoveClock() const;
+
+    /**
+     * @brief Returns the number of the current move, which starts at 1 and increases after every move of black.
+     */
+    int getFullmoveNumber() const;
+
+    /**
+     * @brief Returns how many times the current position occurred before, in O(1).
+     */
+    int getRepetitionCount() const;
+    bool isThreefoldRepetition() const;
+
+    /**
+     * @brief Writes every legal move of the player to move into the list.
+     * @details Covers castling, en passant and the four promotions. The list is cleared first.
+     * @param generation Restricts the moves to captures or to quiet moves. Together they are all legal moves.
+     */
+    void generateLegalMoves(MoveList& moves, MoveGeneration generation = MoveGeneration::All) const;
+
+    /**
+     * @brief Returns the squares the piece on source can legally move to, or an empty set if it is not a piece of the
+     *        player to move.
+     * @details The checkers and pinned pieces are computed once per position, so this costs about one attack lookup
+     *          per call.
+     */
+    Bitboard legalDestinations(const BoardCoordinate source) const;
+
+    /**
+     * @brief Returns the opposing pieces that give check to the king of the player to move.
+     */
+    Bitboard getCheckers() const;
+    bool isInCheck() const;
     bool isLegalMove(const BoardCoordinate source, const BoardCoordinate destiny) const;
+
+    /**
+     * @brief Builds the move that takes the piece on source to destiny, deducing its kind from the position.
+     * @param promotion The piece a pawn reaching the last row promotes to.
+     */
+    Move createMove(const BoardCoordinate source, const BoardCoordinate destiny, PieceType promotion = PieceType::Queen) const;
+
+    /**
+     * @brief Returns the legal move written in coordinate notation, like "e2e4" or "e7e8q", or nullopt if there is none.
+     */
+    std::optional<Move> findMove(std::string_view coordinate_notation) const;
+
+    /**
+     * @brief Returns the index in legal_moves of the move written in Standard Algebraic Notation, like "Nbd7", "exd6",
+     *        "e8=Q+" or "O-O", or nullopt if no move or more than one matches.
+     * @details Check and annotation suffixes are ignored, and so is a missing or superfluous capture sign.
+     * @param legal_moves The legal moves of the position, as generated by generateLegalMoves, in any order.
+     */
+    std::optional<std::size_t> indexOfSanMove(std::string_view san, const MoveList& legal_moves) const;
     void move(const BoardCoordinate source, const BoardCoordinate destiny);
+
+    /**
+     * @brief Plays a move permanently. Moves pending to be unmade are forgotten.
+     */
+    void move(const Move move);
+
+    /**
+     * @brief Plays a move that can be taken back with unmakeMove.
+     * @details Up to max_undo_depth moves can be pending. Throws std::length_error when the undo stack is full.
+     */
+    void makeMove(const Move move);
+
+    /**
+     * @brief Takes back the last move played with makeMove.
+     * @details move, loadFEN and loadCompact forget the moves pending to be unmade. Throws std::logic_error if there
+     *          is none.
+     */
+    void unmakeMove();
 };
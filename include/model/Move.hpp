@@ -0,0 +1,132 @@
+#pragma once
+#include "Bitboard.hpp"
+#include "BoardCoordinate.hpp"
+#include "PieceType.hpp"
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief A move packed into 16 bits.
+ * @details Bits 0-5 hold the source square, bits 6-11 the destiny square and bits 12-15 a flag telling the kind of
+ *          move. Squares are indexed like bitboards. The flag's bit 2 marks captures and bit 3 marks promotions, whose
+ *          low two bits select the promoted piece. A default constructed move is a null move (a1 to a1).
+ */
+class Move {
+public:
+    enum Flag : std::uint16_t {
+        Quiet = 0,
+        DoublePawnPush = 1,
+        KingCastle = 2,
+        QueenCastle = 3,
+        Capture = 4,
+        EnPassant = 5,
+        KnightPromotion = 8,
+        BishopPromotion = 9,
+        RookPromotion = 10,
+        QueenPromotion = 11,
+        KnightPromotionCapture = 12,
+        BishopPromotionCapture = 13,
+        RookPromotionCapture = 14,
+        QueenPromotionCapture = 15
+    };
+
+private:
+    std::uint16_t m_data;
+
+public:
+    constexpr Move()
+        : m_data(0)
+    {
+    }
+
+    constexpr Move(int from, int to, Flag flag = Quiet)
+        : m_data(static_cast<std::uint16_t>(from | (to << 6) | (flag << 12)))
+    {
+    }
+
+    constexpr int getFrom() const
+    {
+        return m_data & 0x3F;
+    }
+
+    constexpr int getTo() const
+    {
+        return (m_data >> 6) & 0x3F;
+    }
+
+    constexpr Flag getFlag() const
+    {
+        return static_cast<Flag>(m_data >> 12);
+    }
+
+    constexpr bool isCapture() const
+    {
+        return getFlag() & Capture;
+    }
+
+    constexpr bool isPromotion() const
+    {
+        return getFlag() & KnightPromotion;
+    }
+
+    constexpr bool isCastling() const
+    {
+        return getFlag() == KingCastle || getFlag() == QueenCastle;
+    }
+
+    constexpr bool isEnPassant() const
+    {
+        return getFlag() == EnPassant;
+    }
+
+    /**
+     * @brief Returns the type the pawn is promoted to. Only meaningful if the move is a promotion.
+     */
+    constexpr PieceType getPromotion() const
+    {
+        constexpr PieceType promotions[4] = { PieceType::Knight, PieceType::Bishop, PieceType::Rook, PieceType::Queen };
+        return promotions[getFlag() & 3];
+    }
+
+    BoardCoordinate getSource() const
+    {
+        return BoardCoordinate(Square(getFrom()));
+    }
+
+    BoardCoordinate getDestiny() const
+    {
+        return BoardCoordinate(Square(getTo()));
+    }
+
+    /**
+     * @brief Returns the move in coordinate notation, as used by UCI: source, destiny and promotion, like "e7e8q".
+     */
+    std::string toCoordinateNotation() const
+    {
+        std::string notation;
+        for (int square : { getFrom(), getTo() }) {
+            notation += static_cast<char>('a' + Bitboards::columnOf(square) - 1);
+            notation += static_cast<char>('0' + Bitboards::rowOf(square));
+        }
+        if (isPromotion()) {
+            constexpr char promotion_letters[] = { 'k', 'q', 'b', 'n', 'r', 'p' };
+            notation += promotion_letters[static_cast<int>(getPromotion())];
+        }
+        return notation;
+    }
+
+    constexpr std::uint16_t getData() const
+    {
+        return m_data;
+    }
+
+    constexpr bool operator==(const Move& that) const
+    {
+        return m_data == that.m_data;
+    }
+
+    constexpr bool operator!=(const Move& that) const
+    {
+        return m_data != that.m_data;
+    }
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include "Move.hpp"
+#include <array>
+#include <cstddef>
+
+/**
+ * @brief A fixed-capacity list of moves meant to live on the stack.
+ * @details No chess position has more than 218 legal moves, so the capacity never overflows and no heap allocation is
+ *          ever needed.
+ */
+class MoveList {
+public:
+    static constexpr std::size_t capacity = 256;
+
+private:
+    std::array<Move, capacity> m_moves;
+    std::size_t m_size;
+
+public:
+    MoveList()
+        : m_size(0)
+    {
+    }
+
+    void push(Move move)
+    {
+        m_moves[m_size++] = move;
+    }
+
+    void clear()
+    {
+        m_size = 0;
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    bool contains(Move move) const
+    {
+        for (std::size_t i = 0; i < m_size; i++) {
+            if (m_moves[i] == move) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Move& operator[](std::size_t index)
+    {
+        return m_moves[index];
+    }
+
+    const Move& operator[](std::size_t index) const
+    {
+        return m_moves[index];
+    }
+
+    Move* begin()
+    {
+        return m_moves.data();
+    }
+
+    Move* end()
+    {
+        return m_moves.data() + m_size;
+    }
+
+    const Move* begin() const
+    {
+        return m_moves.data();
+    }
+
+    const Move* end() const
+    {
+        return m_moves.data() + m_size;
+    }
+};
@@ -18,3 +18,30 @@ public:
     bool operator==(const Piece& that) const;
     bool operator!=(const Piece& that) const;
 };
+
+inline Piece::Piece(PieceColor color, PieceType type)
+    : m_color(color)
+    , m_type(type)
+    , m_has_moved(false)
+{
+}
+
+inline void Piece::setAsMoved()
+{
+    m_has_moved = true;
+}
+
+inline bool Piece::hasMoved() const
+{
+    return m_has_moved;
+}
+
+inline PieceColor Piece::getColor() const
+{
+    return m_color;
+}
+
+inline PieceType Piece::getType() const
+{
+    return m_type;
+}
@@ -1,6 +1,7 @@
 #pragma once
+#include <cstdint>
 
-enum class PieceColor {
+enum class PieceColor : std::uint8_t {
     White = 0,
     Black = 1
-};
\ No newline at end of file
+};
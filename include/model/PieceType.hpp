@@ -1,10 +1,11 @@
 #pragma once
+#include <cstdint>
 
-enum class PieceType {
+enum class PieceType : std::uint8_t {
     King = 0,
     Queen = 1,
     Bishop = 2,
     Knight = 3,
     Rook = 4,
     Pawn = 5
-};
\ No newline at end of file
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include "Bitboard.hpp"
+#include <cstdint>
+
+/**
+ * @brief A square of the board, indexed like the bits of a Bitboard (a1 is 0, h8 is 63).
+ * @details Unlike BoardCoordinate it is never validated, so it is built and read without any branch; use isOnBoard
+ *          first when the column and row come from outside the model.
+ */
+struct Square {
+private:
+    std::uint8_t m_index;
+
+public:
+    Square() = default;
+
+    constexpr explicit Square(int index)
+        : m_index(static_cast<std::uint8_t>(index))
+    {
+    }
+
+    /**
+     * @brief Returns the square on a column and row, both from 1 to 8.
+     */
+    static constexpr Square at(int col, int row)
+    {
+        return Square(Bitboards::squareOf(col, row));
+    }
+
+    static constexpr bool isOnBoard(int col, int row)
+    {
+        return col >= 1 && col <= 8 && row >= 1 && row <= 8;
+    }
+
+    constexpr int index() const
+    {
+        return m_index;
+    }
+
+    constexpr int getCol() const
+    {
+        return Bitboards::columnOf(m_index);
+    }
+
+    constexpr int getRow() const
+    {
+        return Bitboards::rowOf(m_index);
+    }
+
+    constexpr Bitboard bit() const
+    {
+        return Bitboards::squareBit(m_index);
+    }
+
+    constexpr bool operator==(Square that) const
+    {
+        return m_index == that.m_index;
+    }
+
+    constexpr bool operator!=(Square that) const
+    {
+        return m_index != that.m_index;
+    }
+};
@@ -0,0 +1,107 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/// Code paths timed when the program is built with CHESS_STATS.
+enum class StatCounter {
+    IsLegalMove,
+    Move,
+    FindKingPosition,
+    ExistInterrumptions,
+    Draw,
+    /// Time to handle and draw one frame of the game window.
+    Frame,
+    Count
+};
+
+struct StatSummary {
+    /// Frames are bucketed by the time the counter took during them: bucket 0 holds those under a microsecond and
+    /// bucket i those from 2^(i-1) to 2^i microseconds. The last bucket also holds everything slower.
+    static constexpr int frame_histogram_buckets = 20;
+
+    const char* name;
+    std::uint64_t calls;
+    std::uint64_t total_nanoseconds;
+    /// 0 if there were no calls.
+    std::uint64_t min_nanoseconds;
+    std::uint64_t max_nanoseconds;
+    std::array<std::uint64_t, frame_histogram_buckets> frame_histogram;
+};
+
+/**
+ * @brief Call counts and timings of hot code paths, for finding out what a slow frame spent its time on.
+ * @details Timers are placed with CHESS_STATS_TIMER, which compiles to nothing unless CHESS_STATS is defined (the
+ *          CHESS_STATS CMake option), so the default build pays nothing for them. The functions are always available
+ *          and report zeros when the timers are compiled out. Counters are relaxed atomics and can be updated from
+ *          any thread.
+ */
+namespace Stats {
+#if defined(CHESS_STATS)
+    constexpr bool enabled = true;
+#else
+    constexpr bool enabled = false;
+#endif
+
+    const char* nameOf(StatCounter counter);
+
+    /**
+     * @brief Adds one call of the given duration to a counter.
+     */
+    void record(StatCounter counter, std::uint64_t nanoseconds);
+
+    /**
+     * @brief Closes the current frame: adds the time every counter took during it to its histogram.
+     * @return The time every counter took during the frame, indexed by StatCounter.
+     */
+    std::array<std::uint64_t, static_cast<int>(StatCounter::Count)> endFrame();
+
+    StatSummary summary(StatCounter counter);
+    void reset();
+
+    /**
+     * @brief Returns every counter as a JSON object.
+     */
+    std::string toJson();
+
+    /**
+     * @brief Writes toJson to a file, returning false if it cannot be written.
+     */
+    bool writeJson(const std::string& path);
+
+    /**
+     * @brief Records the time between its construction and its destruction.
+     */
+    class ScopedTimer {
+    private:
+        const StatCounter m_counter;
+        const std::chrono::steady_clock::time_point m_start;
+
+    public:
+        explicit ScopedTimer(StatCounter counter)
+            : m_counter(counter)
+            , m_start(std::chrono::steady_clock::now())
+        {
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        ~ScopedTimer()
+        {
+            const auto elapsed = std::chrono::steady_clock::now() - m_start;
+            record(m_counter, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    };
+}
+
+#define CHESS_STATS_CONCATENATE_(a, b) a##b
+#define CHESS_STATS_CONCATENATE(a, b) CHESS_STATS_CONCATENATE_(a, b)
+
+/// Times the rest of the enclosing scope into the given StatCounter when built with CHESS_STATS.
+#if defined(CHESS_STATS)
+#define CHESS_STATS_TIMER(counter) const Stats::ScopedTimer CHESS_STATS_CONCATENATE(stats_timer_, __LINE__)(StatCounter::counter)
+#else
+#define CHESS_STATS_TIMER(counter) static_cast<void>(0)
+#endif
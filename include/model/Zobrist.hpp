@@ -0,0 +1,62 @@
+#pragma once
+#include "Piece.hpp"
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief Random keys whose XOR identifies a position.
+ * @details The keys are generated at compile time from a fixed seed, so hashes are stable across runs and builds.
+ */
+namespace Zobrist {
+    struct Keys {
+        std::array<std::array<std::array<std::uint64_t, 64>, 6>, 2> pieces {};
+        /// Indexed by a castling rights mask, each entry is the XOR of the keys of the rights it contains.
+        std::array<std::uint64_t, 16> castling {};
+        std::array<std::uint64_t, 8> en_passant_column {};
+        std::uint64_t black_to_move = 0;
+    };
+
+    constexpr std::uint64_t splitMix64(std::uint64_t& state)
+    {
+        std::uint64_t result = (state += 0x9E3779B97F4A7C15ULL);
+        result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        result = (result ^ (result >> 27)) * 0x94D049BB133111EBULL;
+        return result ^ (result >> 31);
+    }
+
+    constexpr Keys generateKeys()
+    {
+        Keys keys;
+        std::uint64_t state = 0x43686573732E6370ULL;
+        for (auto& pieces_of_color : keys.pieces) {
+            for (auto& pieces_of_type : pieces_of_color) {
+                for (std::uint64_t& key : pieces_of_type) {
+                    key = splitMix64(state);
+                }
+            }
+        }
+        std::array<std::uint64_t, 4> castling_right_keys {};
+        for (std::uint64_t& key : castling_right_keys) {
+            key = splitMix64(state);
+        }
+        for (int rights = 0; rights < 16; rights++) {
+            for (int right = 0; right < 4; right++) {
+                if (rights & (1 << right)) {
+                    keys.castling[rights] ^= castling_right_keys[right];
+                }
+            }
+        }
+        for (std::uint64_t& key : keys.en_passant_column) {
+            key = splitMix64(state);
+        }
+        keys.black_to_move = splitMix64(state);
+        return keys;
+    }
+
+    inline constexpr Keys keys = generateKeys();
+
+    inline std::uint64_t piece(const Piece& piece, int square)
+    {
+        return keys.pieces[static_cast<int>(piece.getColor())][static_cast<int>(piece.getType())][square];
+    }
+}
@@ -0,0 +1,104 @@
+#include "../include/EngineView.hpp"
+#include "../include/engine/Evaluation.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+    /// Scale of the logistic curve of the bar, at which a score of 400 centipawns fills three quarters of it.
+    constexpr double bar_scale = 364;
+
+    std::string formatScore(int white_score)
+    {
+        char text[16];
+        if (std::abs(white_score) > Score::MateBound) {
+            const int moves = (Score::Mate - std::abs(white_score) + 1) / 2;
+            std::snprintf(text, sizeof(text), "#%s%d", white_score < 0 ? "-" : "", moves);
+        } else {
+            std::snprintf(text, sizeof(text), "%+.2f", white_score / 100.0);
+        }
+        return text;
+    }
+}
+
+EngineView::EngineView(const sf::FloatRect& board)
+    : m_board(board)
+    , m_vertices(sf::Quads)
+    , m_description()
+{
+}
+
+sf::Vector2f EngineView::squareCenter(int square) const
+{
+    const float size = m_board.width / 8;
+    return sf::Vector2f(m_board.left + (Bitboards::columnOf(square) - 0.5f) * size, m_board.top + (8.5f - Bitboards::rowOf(square)) * size);
+}
+
+void EngineView::addRectangle(sf::Vector2f top_left, sf::Vector2f size, sf::Color color)
+{
+    m_vertices.append(sf::Vertex(top_left, color));
+    m_vertices.append(sf::Vertex(sf::Vector2f(top_left.x + size.x, top_left.y), color));
+    m_vertices.append(sf::Vertex(top_left + size, color));
+    m_vertices.append(sf::Vertex(sf::Vector2f(top_left.x, top_left.y + size.y), color));
+}
+
+void EngineView::addArrow(int from, int to, sf::Color color)
+{
+    const sf::Vector2f start = squareCenter(from);
+    const sf::Vector2f end = squareCenter(to);
+    const sf::Vector2f direction = end - start;
+    const float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+    const sf::Vector2f normal(-direction.y / length * arrow_thickness / 2, direction.x / length * arrow_thickness / 2);
+    m_vertices.append(sf::Vertex(start + normal, color));
+    m_vertices.append(sf::Vertex(end + normal, color));
+    m_vertices.append(sf::Vertex(end - normal, color));
+    m_vertices.append(sf::Vertex(start - normal, color));
+    // A square head marks the destiny.
+    addRectangle(end - sf::Vector2f(arrow_thickness, arrow_thickness), sf::Vector2f(2 * arrow_thickness, 2 * arrow_thickness), color);
+}
+
+void EngineView::show(const EngineReport& report, const std::vector<Move>& line, bool pondering)
+{
+    m_vertices.clear();
+
+    // The white part of the bar grows from the bottom with White's chances.
+    double white_share = 1 / (1 + std::exp(-report.white_score / bar_scale));
+    if (std::abs(report.white_score) > Score::MateBound) {
+        white_share = report.white_score > 0 ? 1 : 0;
+    }
+    const sf::Vector2f bar_position(m_board.left + m_board.width + margin, m_board.top);
+    const float white_height = static_cast<float>(m_board.height * white_share);
+    addRectangle(bar_position, sf::Vector2f(bar_width, m_board.height - white_height), sf::Color::Black);
+    addRectangle(sf::Vector2f(bar_position.x, bar_position.y + m_board.height - white_height), sf::Vector2f(bar_width, white_height), sf::Color::White);
+    addRectangle(sf::Vector2f(bar_position.x, bar_position.y + m_board.height / 2 - 1), sf::Vector2f(bar_width, 2), sf::Color::Red);
+
+    // Later moves are fainter.
+    for (int i = 0; i < shown_moves && i < static_cast<int>(line.size()); i++) {
+        if (line[i] == Move()) {
+            break;
+        }
+        addArrow(line[i].getFrom(), line[i].getTo(), sf::Color(30, 110, 230, static_cast<sf::Uint8>(200 - 40 * i)));
+    }
+
+    m_description = pondering ? "pondering, depth " : "thinking, depth ";
+    m_description += std::to_string(report.depth) + ", eval " + formatScore(report.white_score) + ", pv";
+    for (int i = 0; i < described_moves && i < static_cast<int>(line.size()); i++) {
+        m_description += ' ' + line[i].toCoordinateNotation();
+    }
+}
+
+void EngineView::clear()
+{
+    m_vertices.clear();
+    m_description.clear();
+}
+
+const std::string& EngineView::describe() const
+{
+    return m_description;
+}
+
+void EngineView::draw(sf::RenderTarget& target, sf::RenderStates state) const
+{
+    target.draw(m_vertices, state);
+}
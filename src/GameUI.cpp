@@ -1,101 +1,148 @@
 #include "../include/GameUI.hpp"
+#include "../include/model/Stats.hpp"
+#include <algorithm>
 
-void GameUI::update(sf::RenderWindow& window)
+bool GameUI::handleEvent(const sf::Event& event, const sf::RenderTarget& target)
 {
-    sf::Vector2f mousePos = window.mapPixelToCoords(sf::Mouse::getPosition(window));
-    if ((sf::Mouse::isButtonPressed(sf::Mouse::Left) && !this->last_square.has_value())) {
-        // If not grabbing piece, pick up piece if it has started moving
-        this->last_square = fromUiCoordsToBoardCoords(mousePos.x, mousePos.y);
-    } else if (!sf::Mouse::isButtonPressed(sf::Mouse::Left) && this->last_square.has_value()) {
+    switch (event.type) {
+    case sf::Event::MouseButtonPressed: {
+        if (event.mouseButton.button != sf::Mouse::Left || last_square.has_value() || !m_input_enabled) {
+            return false;
+        }
+        // Pick up the piece under the cursor, if any.
+        const sf::Vector2f mousePos = target.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
+        if (!isOnBoard(mousePos)) {
+            return false;
+        }
+        const BoardCoordinate pressed_square = fromUiCoordsToBoardCoords(mousePos.x, mousePos.y);
+        if (!m_game.getBoard().isOccupied(Bitboards::squareOf(pressed_square.getCol(), pressed_square.getRow()))) {
+            return false;
+        }
+        last_square = pressed_square;
+        m_drag_position = mousePos;
+        return true;
+    }
+    case sf::Event::MouseButtonReleased: {
+        if (event.mouseButton.button != sf::Mouse::Left || !last_square.has_value()) {
+            return false;
+        }
         // If piece is dropped, try to move it to current square.
-        BoardCoordinate pressed_square = fromUiCoordsToBoardCoords(mousePos.x, mousePos.y);
-        if (m_game.isLegalMove(this->last_square.value(), pressed_square)) {
-            m_game.move(this->last_square.value(), pressed_square);
+        const sf::Vector2f mousePos = target.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
+        if (m_input_enabled && isOnBoard(mousePos)) {
+            const BoardCoordinate pressed_square = fromUiCoordsToBoardCoords(mousePos.x, mousePos.y);
+            if (m_game.isLegalMove(last_square.value(), pressed_square)) {
+                m_game.move(last_square.value(), pressed_square);
+            }
         }
-        this->last_square.reset();
+        last_square.reset();
+        return true;
+    }
+    case sf::Event::MouseMoved:
+        if (!last_square.has_value()) {
+            return false;
+        }
+        m_drag_position = target.mapPixelToCoords(sf::Vector2i(event.mouseMove.x, event.mouseMove.y));
+        return true;
+    default:
+        return false;
     }
 }
 
-void GameUI::draw(sf::RenderTarget& target, sf::RenderStates state) const
+bool GameUI::isStale() const
 {
-    {
-        bool rectangle_is_white = false;
-        sf::RectangleShape shape(sf::Vector2f(square_size, square_size));
-        for (unsigned int i = board_pos_x; i < board_pos_x + square_size * 8; i += square_size) {
-            for (unsigned int j = board_pos_y; j < board_pos_y + square_size * 8; j += square_size) {
-                shape.setPosition(i, j);
-                if (rectangle_is_white) {
-                    shape.setFillColor(sf::Color(100, 100, 100, 255));
-                    rectangle_is_white = false;
-                } else {
-                    shape.setFillColor(sf::Color::White);
-                    rectangle_is_white = true;
-                }
-                target.draw(shape);
-            }
-            rectangle_is_white = !rectangle_is_white;
-        }
+    return m_built_generation != m_game.getGeneration();
+}
+
+void GameUI::setInputEnabled(bool enabled)
+{
+    m_input_enabled = enabled;
+}
+
+sf::FloatRect GameUI::boardArea()
+{
+    return sf::FloatRect(board_pos_x, board_pos_y, square_size * 8, square_size * 8);
+}
+
+bool GameUI::isOnBoard(const sf::Vector2f& position)
+{
+    return boardArea().contains(position.x, position.y);
+}
+
+int GameUI::spriteIndex(const Piece& piece)
+{
+    return (int)piece.getColor() * 6 + (int)piece.getType();
+}
+
+void GameUI::updatePiecesVertices() const
+{
+    const int hidden_square = last_square.has_value() ? Bitboards::squareOf(last_square->getCol(), last_square->getRow()) : -1;
+    if (m_built_generation == m_game.getGeneration() && m_built_hidden_square == hidden_square) {
+        return;
     }
-    {
-        for (unsigned int i = 1; i <= 8; i++) {
-            for (unsigned int j = 1; j <= 8; j++) {
-                if (m_game.readBoard(i, j).has_value() && !(last_square.has_value() && BoardCoordinate(i, j) == last_square.value())) {
-                    const sf::Sprite& currentPieceSprite = this->pieces_sprites[(int)this->m_game.readBoard(i, j)->getColor() * 6 + (int)this->m_game.readBoard(i, j)->getType()];
-                    sf::Transformable transformer;
-                    sf::RenderStates specific_state = state;
-                    transformer.setPosition(board_pos_x + (i - 1) * square_size, board_pos_y + (8 - j) * square_size);
-                    specific_state.transform *= transformer.getTransform();
-                    target.draw(currentPieceSprite, specific_state);
-                }
-            }
+    m_built_generation = m_game.getGeneration();
+    m_built_hidden_square = hidden_square;
+
+    const Board& board = m_game.getBoard();
+    m_pieces_vertices.clear();
+    for (Bitboard remaining = board.occupied(); remaining != Bitboards::Empty;) {
+        const int square = Bitboards::popLsb(remaining);
+        if (square == hidden_square) {
+            continue;
         }
-        if (last_square.has_value()) {
-            std::optional<Piece> moving_piece = this->m_game.readBoard(this->last_square.value().getCol(), this->last_square.value().getRow());
-            sf::Window* window = dynamic_cast<sf::Window*>(&target);
-            if (window != nullptr) {
-                const sf::Sprite& currentPieceSprite = this->pieces_sprites[(int)moving_piece->getColor() * 6 + (int)moving_piece->getType()];
-                sf::Transformable transformer;
-                sf::RenderStates specific_state;
-                sf::Vector2f mousePos = target.mapPixelToCoords(sf::Mouse::getPosition(*window));
-                sf::FloatRect spriteRectangle = currentPieceSprite.getGlobalBounds();
-                transformer.setPosition(mousePos.x - board_pos_x - spriteRectangle.width / 2, mousePos.y - board_pos_y - spriteRectangle.height / 2);
-                specific_state.transform = transformer.getTransform();
-                target.draw(currentPieceSprite, specific_state);
-            }
+        const int index = spriteIndex(*board.pieceAt(square));
+        const float left = board_pos_x + (Bitboards::columnOf(square) - 1) * square_size;
+        const float top = board_pos_y + (8 - Bitboards::rowOf(square)) * square_size;
+        const float texture_left = (index % 6) * piece_size_in_texture;
+        const float texture_top = (index / 6) * piece_size_in_texture;
+        m_pieces_vertices.append(sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(texture_left, texture_top)));
+        m_pieces_vertices.append(sf::Vertex(sf::Vector2f(left + square_size, top), sf::Vector2f(texture_left + piece_size_in_texture, texture_top)));
+        m_pieces_vertices.append(sf::Vertex(sf::Vector2f(left + square_size, top + square_size),
+            sf::Vector2f(texture_left + piece_size_in_texture, texture_top + piece_size_in_texture)));
+        m_pieces_vertices.append(sf::Vertex(sf::Vector2f(left, top + square_size), sf::Vector2f(texture_left, texture_top + piece_size_in_texture)));
+    }
+}
+
+void GameUI::draw(sf::RenderTarget& target, sf::RenderStates state) const
+{
+    CHESS_STATS_TIMER(Draw);
+    // The whole board is two draw calls, and its geometry is only rebuilt when something moved.
+    updatePiecesVertices();
+    target.draw(m_squares_vertices, state);
+    sf::RenderStates pieces_state = state;
+    pieces_state.texture = &pieces_texture;
+    target.draw(m_pieces_vertices, pieces_state);
+
+    if (last_square.has_value()) {
+        const std::optional<Piece>& moving_piece = m_game.getBoard().pieceAt(Bitboards::squareOf(last_square->getCol(), last_square->getRow()));
+        if (moving_piece.has_value()) {
+            const sf::Sprite& currentPieceSprite = this->pieces_sprites[spriteIndex(*moving_piece)];
+            sf::Transformable transformer;
+            sf::RenderStates specific_state;
+            sf::FloatRect spriteRectangle = currentPieceSprite.getGlobalBounds();
+            transformer.setPosition(m_drag_position.x - board_pos_x - spriteRectangle.width / 2, m_drag_position.y - board_pos_y - spriteRectangle.height / 2);
+            specific_state.transform = transformer.getTransform();
+            target.draw(currentPieceSprite, specific_state);
         }
     }
 }
 
 BoardCoordinate GameUI::fromUiCoordsToBoardCoords(float pos_x, float pos_y)
 {
-    pos_x = (pos_x - board_pos_x) / square_size;
-    pos_y = 8 - ((pos_y - board_pos_y) / square_size);
-    int new_pos_y = pos_y + 1;
-    switch ((int)pos_x) {
-    case 0:
-        return BoardCoordinate(BoardColumn::A, new_pos_y);
-    case 1:
-        return BoardCoordinate(BoardColumn::B, new_pos_y);
-    case 2:
-        return BoardCoordinate(BoardColumn::C, new_pos_y);
-    case 3:
-        return BoardCoordinate(BoardColumn::D, new_pos_y);
-    case 4:
-        return BoardCoordinate(BoardColumn::E, new_pos_y);
-    case 5:
-        return BoardCoordinate(BoardColumn::F, new_pos_y);
-    case 6:
-        return BoardCoordinate(BoardColumn::G, new_pos_y);
-    case 7:
-        return BoardCoordinate(BoardColumn::H, new_pos_y);
-    default:
-        throw std::out_of_range("Square is out of possible range");
-    }
+    // Callers check isOnBoard first; the clamp only keeps points on the far edges on the board.
+    const int col = std::clamp(static_cast<int>((pos_x - board_pos_x) / square_size), 0, 7) + 1;
+    const int row = 8 - std::clamp(static_cast<int>((pos_y - board_pos_y) / square_size), 0, 7);
+    return BoardCoordinate(Square::at(col, row));
 }
 
 GameUI::GameUI(GameState& new_game)
     : m_game(new_game)
     , last_square(std::nullopt)
+    , m_drag_position()
+    , m_squares_vertices(sf::Quads, 64 * 4)
+    , m_pieces_vertices(sf::Quads)
+    , m_built_generation(0)
+    , m_built_hidden_square(-1)
+    , m_input_enabled(true)
 {
     if (!this->pieces_texture.loadFromFile("ChessPieces.png"))
         exit(1);
@@ -106,4 +153,22 @@ GameUI::GameUI(GameState& new_game)
             this->pieces_sprites[i * 6 + j].setScale(float(square_size) / piece_size_in_texture, float(square_size) / piece_size_in_texture);
         }
     }
+
+    for (int column = 0; column < 8; column++) {
+        for (int row = 0; row < 8; row++) {
+            // The top left square, a8, is a light one.
+            const sf::Color color = (column + row) % 2 == 0 ? sf::Color::White : sf::Color(100, 100, 100, 255);
+            const float left = board_pos_x + column * square_size;
+            const float top = board_pos_y + row * square_size;
+            sf::Vertex* quad = &m_squares_vertices[(column * 8 + row) * 4];
+            quad[0] = sf::Vertex(sf::Vector2f(left, top), color);
+            quad[1] = sf::Vertex(sf::Vector2f(left + square_size, top), color);
+            quad[2] = sf::Vertex(sf::Vector2f(left + square_size, top + square_size), color);
+            quad[3] = sf::Vertex(sf::Vector2f(left, top + square_size), color);
+        }
+    }
+    // Reserve room for all 32 pieces so rebuilding never allocates.
+    m_pieces_vertices.resize(32 * 4);
+    m_pieces_vertices.clear();
+    updatePiecesVertices();
 }
@@ -0,0 +1,98 @@
+#include "../include/StatsOverlay.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+    constexpr double frame_budget_nanoseconds = 1e9 / 60;
+    /// Frame time at the top of the upper graph, twice the budget.
+    constexpr double frame_scale_nanoseconds = 2 * frame_budget_nanoseconds;
+    /// Validation time at the top of the lower graph.
+    constexpr double validation_scale_nanoseconds = 1e6;
+}
+
+StatsOverlay::StatsOverlay()
+    : m_frame_nanoseconds()
+    , m_validation_nanoseconds()
+    , m_next(0)
+    , m_visible(false)
+    , m_vertices(sf::Quads)
+{
+    m_vertices.resize((2 + 2 * history_size) * 4);
+    m_vertices.clear();
+}
+
+void StatsOverlay::toggle()
+{
+    m_visible = !m_visible;
+    if (m_visible) {
+        rebuild();
+    }
+}
+
+bool StatsOverlay::isVisible() const
+{
+    return m_visible;
+}
+
+void StatsOverlay::addFrame(std::uint64_t frame_nanoseconds, std::uint64_t validation_nanoseconds)
+{
+    m_frame_nanoseconds[m_next] = frame_nanoseconds;
+    m_validation_nanoseconds[m_next] = validation_nanoseconds;
+    m_next = (m_next + 1) % history_size;
+    if (m_visible) {
+        rebuild();
+    }
+}
+
+std::string StatsOverlay::describe() const
+{
+    std::uint64_t total_frame = 0;
+    std::uint64_t worst_frame = 0;
+    std::uint64_t total_validation = 0;
+    for (int i = 0; i < history_size; i++) {
+        total_frame += m_frame_nanoseconds[i];
+        worst_frame = std::max(worst_frame, m_frame_nanoseconds[i]);
+        total_validation += m_validation_nanoseconds[i];
+    }
+    char text[128];
+    std::snprintf(text, sizeof(text), "frame %.2f ms (worst %.2f ms), move validation %.1f us per frame",
+        total_frame / 1e6 / history_size, worst_frame / 1e6, total_validation / 1e3 / history_size);
+    return text;
+}
+
+void StatsOverlay::addRectangle(float left, float top, float width, float height, sf::Color color)
+{
+    m_vertices.append(sf::Vertex(sf::Vector2f(left, top), color));
+    m_vertices.append(sf::Vertex(sf::Vector2f(left + width, top), color));
+    m_vertices.append(sf::Vertex(sf::Vector2f(left + width, top + height), color));
+    m_vertices.append(sf::Vertex(sf::Vector2f(left, top + height), color));
+}
+
+void StatsOverlay::rebuild()
+{
+    const float width = history_size * bar_width;
+    const float frame_bottom = margin + graph_height;
+    const float validation_bottom = frame_bottom + margin + graph_height;
+    m_vertices.clear();
+    addRectangle(margin / 2, margin / 2, width + margin, validation_bottom, sf::Color(0, 0, 0, 160));
+    const float budget_height = static_cast<float>(graph_height * frame_budget_nanoseconds / frame_scale_nanoseconds);
+    addRectangle(margin, frame_bottom - budget_height, width, 1, sf::Color::Yellow);
+
+    // Oldest frame on the left.
+    for (int i = 0; i < history_size; i++) {
+        const int frame = (m_next + i) % history_size;
+        const float left = margin + i * bar_width;
+        const float frame_height = static_cast<float>(graph_height * std::min(1.0, m_frame_nanoseconds[frame] / frame_scale_nanoseconds));
+        const sf::Color frame_color = m_frame_nanoseconds[frame] > frame_budget_nanoseconds ? sf::Color::Red : sf::Color::Green;
+        addRectangle(left, frame_bottom - frame_height, bar_width, frame_height, frame_color);
+        const float validation_height = static_cast<float>(graph_height * std::min(1.0, m_validation_nanoseconds[frame] / validation_scale_nanoseconds));
+        addRectangle(left, validation_bottom - validation_height, bar_width, validation_height, sf::Color::Blue);
+    }
+}
+
+void StatsOverlay::draw(sf::RenderTarget& target, sf::RenderStates state) const
+{
+    if (m_visible) {
+        target.draw(m_vertices, state);
+    }
+}
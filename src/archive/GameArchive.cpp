@@ -0,0 +1,246 @@
+#include "../../include/archive/GameArchive.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    using PositionBytes = std::array<unsigned char, ArchiveFormat::position_size>;
+
+    std::uint64_t readLittleEndian(const unsigned char* bytes, int count)
+    {
+        std::uint64_t value = 0;
+        for (int i = count - 1; i >= 0; i--) {
+            value = value << 8 | bytes[i];
+        }
+        return value;
+    }
+
+    void writeLittleEndian(unsigned char* bytes, std::uint64_t value, int count)
+    {
+        for (int i = 0; i < count; i++) {
+            bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+        }
+    }
+
+    /// Writes the fields one by one, so the layout does not depend on the padding of CompactPosition.
+    PositionBytes packPosition(const CompactPosition& position)
+    {
+        PositionBytes bytes;
+        writeLittleEndian(bytes.data(), position.occupied, 8);
+        std::copy(position.pieces.begin(), position.pieces.end(), bytes.begin() + 8);
+        writeLittleEndian(bytes.data() + 24, position.halfmove_clock, 2);
+        writeLittleEndian(bytes.data() + 26, position.fullmove_number, 2);
+        bytes[28] = position.flags;
+        bytes[29] = position.en_passant_column;
+        return bytes;
+    }
+
+    CompactPosition unpackPosition(const unsigned char* bytes)
+    {
+        CompactPosition position {};
+        position.occupied = readLittleEndian(bytes, 8);
+        std::copy(bytes + 8, bytes + 24, position.pieces.begin());
+        position.halfmove_clock = static_cast<std::uint16_t>(readLittleEndian(bytes + 24, 2));
+        position.fullmove_number = static_cast<std::uint16_t>(readLittleEndian(bytes + 26, 2));
+        position.flags = bytes[28];
+        position.en_passant_column = bytes[29];
+        return position;
+    }
+
+    const CompactPosition& initialPosition()
+    {
+        static const CompactPosition position = GameState().toCompact();
+        return position;
+    }
+
+    /**
+     * @brief Returns the size of an existing file, writing the magic if it is empty, or throws std::runtime_error if it
+     *        starts with another magic.
+     */
+    std::uint64_t prepareFile(std::ofstream& stream, const std::string& path, const char* magic)
+    {
+        std::ifstream existing(path, std::ios::binary | std::ios::ate);
+        const std::uint64_t size = existing ? static_cast<std::uint64_t>(existing.tellg()) : 0;
+        if (size > 0) {
+            char found[ArchiveFormat::magic_size] = {};
+            existing.seekg(0);
+            existing.read(found, sizeof(found));
+            if (!existing || std::memcmp(found, magic, sizeof(found)) != 0) {
+                throw std::runtime_error(path + " is not a game archive");
+            }
+        }
+        stream.open(path, std::ios::binary | std::ios::app);
+        if (!stream) {
+            throw std::runtime_error("Cannot open the game archive " + path);
+        }
+        if (size == 0) {
+            stream.write(magic, ArchiveFormat::magic_size);
+            return ArchiveFormat::magic_size;
+        }
+        return size;
+    }
+}
+
+void ArchiveFormat::legalMoves(const GameState& state, MoveList& moves)
+{
+    state.generateLegalMoves(moves);
+    std::sort(moves.begin(), moves.end(), [](Move a, Move b) { return a.getData() < b.getData(); });
+}
+
+void ArchiveFormat::encodeGame(const CompactPosition& start, const std::vector<std::uint8_t>& move_indices, GameResult result,
+    std::vector<unsigned char>& bytes)
+{
+    const PositionBytes position_bytes = packPosition(start);
+    const bool custom_start = position_bytes != packPosition(initialPosition());
+    const std::size_t header = bytes.size();
+    bytes.resize(header + game_header_size);
+    writeLittleEndian(bytes.data() + header, move_indices.size(), 2);
+    bytes[header + 2] = static_cast<unsigned char>(result);
+    bytes[header + 3] = custom_start ? custom_start_flag : 0;
+    if (custom_start) {
+        bytes.insert(bytes.end(), position_bytes.begin(), position_bytes.end());
+    }
+    bytes.insert(bytes.end(), move_indices.begin(), move_indices.end());
+}
+
+GameArchiveWriter::GameArchiveWriter(const std::string& path)
+    : m_offset(0)
+{
+    m_offset = prepareFile(m_games, path, ArchiveFormat::games_magic);
+    prepareFile(m_index, path + ArchiveFormat::index_extension, ArchiveFormat::index_magic);
+}
+
+void GameArchiveWriter::append(const GameState& start, const std::vector<Move>& moves, GameResult result)
+{
+    if (moves.size() > ArchiveFormat::max_plies) {
+        throw std::invalid_argument("A game of the archive has at most 65535 plies");
+    }
+    const CompactPosition position = start.toCompact();
+    m_state.loadCompact(position);
+    m_move_indices.clear();
+    MoveList legal_moves;
+    for (const Move move : moves) {
+        ArchiveFormat::legalMoves(m_state, legal_moves);
+        const Move* found = std::find(legal_moves.begin(), legal_moves.end(), move);
+        if (found == legal_moves.end()) {
+            throw std::invalid_argument("Illegal move " + move.toCoordinateNotation() + " in a game of the archive");
+        }
+        // No position has more than 218 legal moves, so the index always fits in a byte.
+        m_move_indices.push_back(static_cast<std::uint8_t>(found - legal_moves.begin()));
+        m_state.move(move);
+    }
+    m_buffer.clear();
+    ArchiveFormat::encodeGame(position, m_move_indices, result, m_buffer);
+    appendEncoded(m_buffer.data(), m_buffer.size());
+}
+
+void GameArchiveWriter::append(const std::vector<Move>& moves, GameResult result)
+{
+    m_state.loadCompact(initialPosition());
+    append(m_state, moves, result);
+}
+
+void GameArchiveWriter::appendEncoded(const unsigned char* game, std::size_t size)
+{
+    unsigned char offset[8];
+    writeLittleEndian(offset, m_offset, 8);
+    m_games.write(reinterpret_cast<const char*>(game), static_cast<std::streamsize>(size));
+    m_index.write(reinterpret_cast<const char*>(offset), sizeof(offset));
+    m_offset += size;
+}
+
+void GameArchiveWriter::flush()
+{
+    // The games go first, so that a reader never finds an offset past the end of the games file.
+    m_games.flush();
+    m_index.flush();
+    if (!m_games || !m_index) {
+        throw std::runtime_error("Cannot write the game archive");
+    }
+}
+
+ArchivedGame::ArchivedGame(const unsigned char* data, std::size_t plies, GameResult result)
+    : m_data(data)
+    , m_plies(plies)
+    , m_result(result)
+{
+}
+
+std::size_t ArchivedGame::plies() const
+{
+    return m_plies;
+}
+
+GameResult ArchivedGame::getResult() const
+{
+    return m_result;
+}
+
+bool ArchivedGame::hasCustomStart() const
+{
+    return (m_data[3] & ArchiveFormat::custom_start_flag) != 0;
+}
+
+const unsigned char* ArchivedGame::moves() const
+{
+    return m_data + ArchiveFormat::game_header_size + (hasCustomStart() ? ArchiveFormat::position_size : 0);
+}
+
+void ArchivedGame::loadStart(GameState& state) const
+{
+    if (hasCustomStart()) {
+        state.loadCompact(unpackPosition(m_data + ArchiveFormat::game_header_size));
+    } else {
+        state.loadCompact(initialPosition());
+    }
+}
+
+Move ArchivedGame::moveAt(const GameState& state, std::size_t ply) const
+{
+    MoveList legal_moves;
+    ArchiveFormat::legalMoves(state, legal_moves);
+    const std::size_t index = moves()[ply];
+    if (index >= legal_moves.size()) {
+        throw std::runtime_error("Corrupt game archive: move index out of range");
+    }
+    return legal_moves[index];
+}
+
+GameArchive::GameArchive(const std::string& path)
+    : m_games(path)
+    , m_index(path + ArchiveFormat::index_extension)
+    , m_size(0)
+{
+    if (m_games.size() < ArchiveFormat::magic_size
+        || std::memcmp(m_games.data(), ArchiveFormat::games_magic, ArchiveFormat::magic_size) != 0
+        || m_index.size() < ArchiveFormat::magic_size
+        || std::memcmp(m_index.data(), ArchiveFormat::index_magic, ArchiveFormat::magic_size) != 0) {
+        throw std::runtime_error(path + " is not a game archive");
+    }
+    // A writer may have been interrupted in the middle of an offset, which is then ignored.
+    m_size = (m_index.size() - ArchiveFormat::magic_size) / 8;
+}
+
+std::size_t GameArchive::size() const
+{
+    return m_size;
+}
+
+ArchivedGame GameArchive::game(std::size_t index) const
+{
+    if (index >= m_size) {
+        throw std::out_of_range("There is no game " + std::to_string(index) + " in the archive");
+    }
+    const std::uint64_t offset = readLittleEndian(m_index.data() + ArchiveFormat::magic_size + index * 8, 8);
+    if (offset < ArchiveFormat::magic_size || offset + ArchiveFormat::game_header_size > m_games.size()) {
+        throw std::runtime_error("Corrupt game archive: game offset out of range");
+    }
+    const unsigned char* data = m_games.data() + offset;
+    const std::size_t plies = static_cast<std::size_t>(readLittleEndian(data, 2));
+    const std::size_t size = ArchiveFormat::game_header_size + (data[3] & ArchiveFormat::custom_start_flag ? ArchiveFormat::position_size : 0) + plies;
+    if (offset + size > m_games.size()) {
+        throw std::runtime_error("Corrupt game archive: game runs past the end of the file");
+    }
+    return ArchivedGame(data, plies, static_cast<GameResult>(data[2]));
+}
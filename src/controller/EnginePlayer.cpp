@@ -0,0 +1,120 @@
+#include "../../include/controller/EnginePlayer.hpp"
+#include <utility>
+
+namespace {
+    std::int64_t nanosecondsSinceEpoch(std::chrono::steady_clock::time_point time)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+}
+
+EnginePlayer::EnginePlayer(int threads, std::shared_ptr<const OpeningBook> book)
+    : m_engine(16, threads)
+    , m_pending(std::nullopt)
+    , m_quit(false)
+    , m_latest_search(0)
+    , m_deadline(0)
+    , m_reports()
+{
+    m_engine.setBook(std::move(book));
+    // Started last, once everything it uses is constructed.
+    m_thread = std::thread(&EnginePlayer::run, this);
+}
+
+EnginePlayer::~EnginePlayer()
+{
+    cancel();
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wakeup.notify_one();
+    m_thread.join();
+}
+
+void EnginePlayer::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wakeup.wait(lock, [this]() { return m_quit || m_pending.has_value(); });
+        if (m_quit) {
+            return;
+        }
+        Request request = std::move(m_pending.value());
+        m_pending.reset();
+        // Under the mutex, so a later request or cancel stops this search even if it has not started yet.
+        m_engine.prepareSearch();
+        lock.unlock();
+
+        const int white_sign = request.state.getTurnColor() == PieceColor::White ? 1 : -1;
+        const auto publish = [&](const SearchResult& result, bool finished) {
+            EngineReport report;
+            report.search = request.search;
+            report.finished = finished;
+            report.best_move = result.best_move;
+            report.pv = result.pv;
+            report.white_score = white_sign * result.score;
+            report.depth = result.depth;
+            report.nodes = result.nodes;
+            m_reports.publish(report);
+        };
+        const SearchResult result = m_engine.search(request.state, request.limits, [&](const SearchResult& iteration) { publish(iteration, false); });
+        publish(result, true);
+        lock.lock();
+    }
+}
+
+std::uint64_t EnginePlayer::request(const GameState& state, const SearchLimits& limits)
+{
+    // Requests are only made by the game thread, so nobody else changes the identifier meanwhile.
+    const std::uint64_t search = m_latest_search.load(std::memory_order_relaxed) + 1;
+    Request request { search, state, limits };
+    m_deadline.store(0, std::memory_order_relaxed);
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        // Stops the previous search before this one can be prepared.
+        m_engine.stop();
+        m_pending = std::move(request);
+        m_latest_search.store(search, std::memory_order_relaxed);
+    }
+    m_wakeup.notify_one();
+    return search;
+}
+
+std::uint64_t EnginePlayer::think(const GameState& state, int movetime)
+{
+    SearchLimits limits;
+    limits.movetime = movetime;
+    return request(state, limits);
+}
+
+std::uint64_t EnginePlayer::ponder(const GameState& state)
+{
+    return request(state, SearchLimits());
+}
+
+void EnginePlayer::ponderHit(int movetime)
+{
+    m_deadline.store(nanosecondsSinceEpoch(std::chrono::steady_clock::now() + std::chrono::milliseconds(movetime)), std::memory_order_relaxed);
+}
+
+void EnginePlayer::cancel()
+{
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.reset();
+        m_latest_search.fetch_add(1, std::memory_order_relaxed);
+        m_engine.stop();
+    }
+    m_deadline.store(0, std::memory_order_relaxed);
+}
+
+const EngineReport* EnginePlayer::poll()
+{
+    // Stopping a search that has not started yet is fine too, since it was prepared.
+    const std::int64_t deadline = m_deadline.load(std::memory_order_relaxed);
+    if (deadline != 0 && nanosecondsSinceEpoch(std::chrono::steady_clock::now()) >= deadline) {
+        m_engine.stop();
+    }
+    return m_reports.receive();
+}
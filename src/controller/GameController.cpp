@@ -1,35 +1,229 @@
 #include "../../include/controller/GameController.hpp"
+#include "../../include/model/Stats.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    std::shared_ptr<const OpeningBook> loadBook(const char* path)
+    {
+        if (!std::ifstream(path)) {
+            return nullptr;
+        }
+        try {
+            return std::make_shared<const OpeningBook>(path);
+        } catch (const std::runtime_error& error) {
+            std::cerr << error.what() << '\n';
+            return nullptr;
+        }
+    }
+
+    /// Leaves a core to the window when there is more than one.
+    int engineThreads()
+    {
+        return std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1);
+    }
+}
 
 GameController::GameController()
-    : m_window(sf::VideoMode(800, 800), "New Game - Chess.cpp")
+    : m_window(sf::VideoMode(800, 800), window_title)
     , m_game()
     , m_view(m_game)
+    , m_stats_overlay()
+    , m_engine_view(GameUI::boardArea())
+    , m_engine(engineThreads(), loadBook(book_file))
+    , m_engine_color(PieceColor::Black)
+    , m_engine_task(EngineTask::Idle)
+    , m_engine_search(0)
+    , m_engine_report()
+    , m_ponder_move()
+    , m_ponder_hash(0)
+    , m_engine_generation(0)
+    , m_title(window_title)
+{
+    startEngine();
+}
+
+bool GameController::updateEngine()
+{
+    bool changed = false;
+    const EngineReport* report = m_engine.poll();
+    if (report != nullptr && report->search == m_engine_search && m_engine_task != EngineTask::Idle) {
+        m_engine_report = *report;
+        if (m_engine_task == EngineTask::Pondering) {
+            // The search starts after the predicted reply, which is shown first.
+            std::vector<Move> line = { m_ponder_move };
+            line.insert(line.end(), m_engine_report.pv.begin(), m_engine_report.pv.end());
+            m_engine_view.show(m_engine_report, line, true);
+        } else {
+            m_engine_view.show(m_engine_report, m_engine_report.pv, false);
+        }
+        changed = true;
+    }
+    if (m_game.getGeneration() != m_engine_generation) {
+        startEngine();
+        changed = true;
+    }
+    if (m_engine_task == EngineTask::Thinking && m_engine_report.finished && m_engine_report.search == m_engine_search) {
+        playEngineMove();
+        changed = true;
+    }
+    return changed;
+}
+
+void GameController::startEngine()
+{
+    m_engine_generation = m_game.getGeneration();
+    const bool engine_to_move = m_engine_color == m_game.getTurnColor();
+    m_view.setInputEnabled(!engine_to_move);
+    MoveList moves;
+    m_game.generateLegalMoves(moves);
+    if (!m_engine_color.has_value() || moves.empty()) {
+        m_engine.cancel();
+        m_engine_task = EngineTask::Idle;
+        m_engine_view.clear();
+        return;
+    }
+
+    if (engine_to_move) {
+        if (m_engine_task == EngineTask::Pondering && m_game.getHash() == m_ponder_hash) {
+            // The player made the predicted move, so the search goes on, now against the clock.
+            m_engine.ponderHit(engine_move_time);
+        } else {
+            m_engine_search = m_engine.think(m_game, engine_move_time);
+            m_engine_report = EngineReport();
+        }
+        m_engine_task = EngineTask::Thinking;
+        return;
+    }
+
+    if (std::find(moves.begin(), moves.end(), m_ponder_move) != moves.end()) {
+        GameState predicted = m_game;
+        predicted.move(m_ponder_move);
+        m_ponder_hash = predicted.getHash();
+        m_engine_search = m_engine.ponder(predicted);
+        m_engine_report = EngineReport();
+        m_engine_task = EngineTask::Pondering;
+        return;
+    }
+    m_engine.cancel();
+    m_engine_task = EngineTask::Idle;
+}
+
+void GameController::playEngineMove()
 {
-    m_window.setFramerateLimit(60);
+    const Move move = m_engine_report.best_move;
+    MoveList moves;
+    m_game.generateLegalMoves(moves);
+    m_engine_task = EngineTask::Idle;
+    if (std::find(moves.begin(), moves.end(), move) == moves.end()) {
+        return;
+    }
+    m_ponder_move = m_engine_report.pv.size() > 1 ? m_engine_report.pv[1] : Move();
+    m_game.move(move);
+    startEngine();
+}
+
+void GameController::updateTitle()
+{
+    std::string title = window_title;
+    if (!m_engine_view.describe().empty()) {
+        title += " - " + m_engine_view.describe();
+    }
+    if (m_stats_overlay.isVisible()) {
+        title += " - " + m_stats_overlay.describe();
+    }
+    if (title != m_title) {
+        m_title = title;
+        m_window.setTitle(m_title);
+    }
 }
 
 void GameController::run()
 {
+    const sf::Time frame_time = sf::seconds(1.f / frames_per_second);
+    sf::Clock frame_clock;
+    bool needs_redraw = true;
+    int frames = 0;
     // Run loop until the window is closed
     while (m_window.isOpen()) {
-        // Event loop
+        const auto frame_start = std::chrono::steady_clock::now();
+        // Handle every pending event, not just one per frame, so input never queues up.
         sf::Event event;
-        if (m_window.pollEvent(event)) {
+        while (m_window.pollEvent(event)) {
             switch (event.type) {
             case sf::Event::Closed:
                 m_window.close();
                 break;
+            case sf::Event::Resized:
+            case sf::Event::GainedFocus:
+                needs_redraw = true;
+                break;
+            case sf::Event::KeyPressed:
+                if (event.key.code == sf::Keyboard::F2) {
+                    // The computer switches from Black to White to neither.
+                    if (m_engine_color == PieceColor::Black) {
+                        m_engine_color = PieceColor::White;
+                    } else if (m_engine_color == PieceColor::White) {
+                        m_engine_color.reset();
+                    } else {
+                        m_engine_color = PieceColor::Black;
+                    }
+                    m_ponder_move = Move();
+                    startEngine();
+                    needs_redraw = true;
+                } else if (event.key.code == sf::Keyboard::F3) {
+                    m_stats_overlay.toggle();
+                    needs_redraw = true;
+                }
+                break;
             default:
+                needs_redraw = m_view.handleEvent(event, m_window) || needs_redraw;
                 break;
             }
         }
+        if (!m_window.isOpen()) {
+            break;
+        }
+        needs_redraw = updateEngine() || needs_redraw;
 
-        // Update the window only if it is focused
-        if (m_window.hasFocus()) {
-            m_view.update(m_window);
+        // Draw only when something changed, so an idle board costs next to nothing.
+        if (needs_redraw || m_view.isStale() || m_stats_overlay.isVisible()) {
             m_window.clear(sf::Color::Magenta);
             m_window.draw(m_view);
+            m_window.draw(m_engine_view);
+            m_window.draw(m_stats_overlay);
             m_window.display();
+            needs_redraw = false;
+
+            const std::uint64_t frame_nanoseconds = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - frame_start).count());
+            if (Stats::enabled) {
+                Stats::record(StatCounter::Frame, frame_nanoseconds);
+            }
+            const auto counter_times = Stats::endFrame();
+            const std::uint64_t validation_nanoseconds = counter_times[static_cast<int>(StatCounter::IsLegalMove)]
+                + counter_times[static_cast<int>(StatCounter::ExistInterrumptions)]
+                + counter_times[static_cast<int>(StatCounter::FindKingPosition)];
+            m_stats_overlay.addFrame(frame_nanoseconds, validation_nanoseconds);
+        }
+        // No font ships with the game, so the figures go to the title, twice a second.
+        if (++frames % (frames_per_second / 2) == 0) {
+            updateTitle();
         }
+
+        // Sleep for the rest of the frame instead of spinning.
+        const sf::Time elapsed = frame_clock.getElapsedTime();
+        if (elapsed < frame_time) {
+            sf::sleep(frame_time - elapsed);
+        }
+        frame_clock.restart();
     }
-}
\ No newline at end of file
+
+    if (Stats::enabled && !Stats::writeJson(stats_file)) {
+        std::cerr << "Cannot write " << stats_file << '\n';
+    }
+}
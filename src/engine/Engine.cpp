@@ -0,0 +1,98 @@
+#include "../../include/engine/Engine.hpp"
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+Engine::Engine(std::size_t hash_megabytes, int threads)
+    : m_table(hash_megabytes)
+    , m_stop(false)
+    , m_prepared(false)
+    , m_book_random(std::random_device()())
+{
+    setThreads(threads);
+}
+
+void Engine::setHashSize(std::size_t megabytes)
+{
+    m_table.resize(megabytes);
+}
+
+void Engine::clearHash()
+{
+    m_table.clear();
+}
+
+void Engine::setThreads(int threads)
+{
+    m_workers.clear();
+    for (int id = 0; id < std::max(threads, 1); id++) {
+        m_workers.push_back(std::make_unique<SearchWorker>(m_table, m_stop, id));
+    }
+}
+
+int Engine::hashfull() const
+{
+    return m_table.hashfull();
+}
+
+void Engine::setBook(std::shared_ptr<const OpeningBook> book)
+{
+    m_book = std::move(book);
+}
+
+int Engine::getThreads() const
+{
+    return static_cast<int>(m_workers.size());
+}
+
+void Engine::stop()
+{
+    m_stop.store(true, std::memory_order_relaxed);
+}
+
+void Engine::prepareSearch()
+{
+    m_stop.store(false, std::memory_order_relaxed);
+    m_prepared.store(true, std::memory_order_release);
+}
+
+SearchResult Engine::search(const GameState& state, const SearchLimits& limits, const IterationCallback& on_iteration)
+{
+    if (!m_prepared.exchange(false, std::memory_order_acq_rel)) {
+        m_stop.store(false, std::memory_order_relaxed);
+    }
+    if (m_book != nullptr) {
+        const std::optional<Move> book_move = m_book->pickMove(state, m_book_random());
+        if (book_move.has_value()) {
+            SearchResult result;
+            result.best_move = book_move.value();
+            result.pv.push_back(book_move.value());
+            return result;
+        }
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+    m_table.newSearch();
+
+    std::vector<SearchWorker*> workers;
+    for (const std::unique_ptr<SearchWorker>& worker : m_workers) {
+        worker->resetNodes();
+        workers.push_back(worker.get());
+    }
+    std::vector<std::thread> helpers;
+    for (std::size_t i = 1; i < workers.size(); i++) {
+        helpers.emplace_back([&, i]() { workers[i]->search(state, limits, start_time, workers, nullptr); });
+    }
+    workers[0]->search(state, limits, start_time, workers, on_iteration);
+    // The helpers have no limits of their own and search until the main worker is done.
+    m_stop.store(true, std::memory_order_relaxed);
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+
+    SearchResult result = workers[0]->getResult();
+    for (std::size_t i = 1; i < workers.size(); i++) {
+        result.nodes += workers[i]->getNodes();
+    }
+    return result;
+}
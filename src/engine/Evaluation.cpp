@@ -0,0 +1,73 @@
+#include "../../include/engine/Evaluation.hpp"
+#include "../../include/model/Attacks.hpp"
+#include <algorithm>
+
+int Evaluation::evaluate(const GameState& state)
+{
+    // Blend the middlegame and endgame terms by how much material is left.
+    const TaperedScore terms = state.getPieceSquareScore();
+    const int phase = std::min(state.getPhase(), PieceSquare::max_phase);
+    const int score = (terms.midgame * phase + terms.endgame * (PieceSquare::max_phase - phase)) / PieceSquare::max_phase;
+    return state.getTurnColor() == PieceColor::White ? score : -score;
+}
+
+int Evaluation::staticExchange(const GameState& state, Move move)
+{
+    // The king is worth more than anything, so capturing with it only pays off when nothing can recapture.
+    constexpr std::array<int, 6> exchange_values = { 20000, 900, 330, 320, 500, 100 };
+    constexpr PieceType cheapest_first[6] = { PieceType::Pawn, PieceType::Knight, PieceType::Bishop, PieceType::Rook,
+        PieceType::Queen, PieceType::King };
+    const Board& board = state.getBoard();
+    const int from = move.getFrom();
+    const int to = move.getTo();
+
+    std::array<int, 32> gains;
+    Bitboard occupied = board.occupied() ^ Bitboards::squareBit(from);
+    if (move.isEnPassant()) {
+        occupied ^= Bitboards::squareBit(to + (state.getTurnColor() == PieceColor::White ? -8 : 8));
+        gains[0] = exchange_values[static_cast<int>(PieceType::Pawn)];
+    } else {
+        gains[0] = board.isOccupied(to) ? exchange_values[static_cast<int>(board.pieceAt(to)->getType())] : 0;
+    }
+    int attacker_value = exchange_values[static_cast<int>(board.pieceAt(from)->getType())];
+    const Bitboard diagonal_sliders = board.pieces(PieceType::Bishop) | board.pieces(PieceType::Queen);
+    const Bitboard straight_sliders = board.pieces(PieceType::Rook) | board.pieces(PieceType::Queen);
+    Bitboard attackers = (Attacks::pawn(PieceColor::Black, to) & board.pieces(PieceColor::White, PieceType::Pawn))
+        | (Attacks::pawn(PieceColor::White, to) & board.pieces(PieceColor::Black, PieceType::Pawn))
+        | (Attacks::knight(to) & board.pieces(PieceType::Knight)) | (Attacks::king(to) & board.pieces(PieceType::King))
+        | (Attacks::bishop(to, occupied) & diagonal_sliders) | (Attacks::rook(to, occupied) & straight_sliders);
+
+    PieceColor side = state.getTurnColor() == PieceColor::White ? PieceColor::Black : PieceColor::White;
+    int depth = 0;
+    while (depth + 1 < static_cast<int>(gains.size())) {
+        attackers &= occupied;
+        const Bitboard ours = attackers & board.pieces(side);
+        if (ours == Bitboards::Empty) {
+            break;
+        }
+        depth++;
+        // The piece that captured last is now the one at stake.
+        gains[depth] = attacker_value - gains[depth - 1];
+        if (std::max(-gains[depth - 1], gains[depth]) < 0) {
+            // Neither capturing nor standing pat changes the outcome from here.
+            depth--;
+            break;
+        }
+        for (PieceType type : cheapest_first) {
+            const Bitboard candidates = ours & board.pieces(type);
+            if (candidates != Bitboards::Empty) {
+                occupied ^= Bitboards::squareBit(Bitboards::lsb(candidates));
+                attacker_value = exchange_values[static_cast<int>(type)];
+                break;
+            }
+        }
+        // Removing the attacker can uncover a slider behind it.
+        attackers |= (Attacks::bishop(to, occupied) & diagonal_sliders) | (Attacks::rook(to, occupied) & straight_sliders);
+        side = side == PieceColor::White ? PieceColor::Black : PieceColor::White;
+    }
+    while (depth > 0) {
+        gains[depth - 1] = -std::max(-gains[depth - 1], gains[depth]);
+        depth--;
+    }
+    return gains[0];
+}
@@ -0,0 +1,204 @@
+#include "../../include/engine/MovePicker.hpp"
+#include "../../include/engine/Evaluation.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+HistoryTable::HistoryTable()
+{
+    clear();
+}
+
+void HistoryTable::clear()
+{
+    for (auto& by_from : m_scores) {
+        for (auto& by_to : by_from) {
+            by_to.fill(0);
+        }
+    }
+}
+
+int HistoryTable::get(PieceColor color, Move move) const
+{
+    return m_scores[static_cast<int>(color)][move.getFrom()][move.getTo()];
+}
+
+void HistoryTable::update(PieceColor color, Move move, int bonus)
+{
+    int& score = m_scores[static_cast<int>(color)][move.getFrom()][move.getTo()];
+    bonus = std::max(-max_score, std::min(bonus, max_score));
+    score += bonus - score * std::abs(bonus) / max_score;
+}
+
+MovePicker::MovePicker(const GameState& state, const HistoryTable& history, Move hash_move,
+    const std::array<Move, 2>& killers, Move countermove)
+    : m_state(state)
+    , m_history(history)
+    , m_stage(Stage::HashMove)
+    , m_hash_move(hash_move)
+    , m_killers(killers)
+    , m_countermove(countermove)
+    , m_skip_quiets(false)
+    , m_index(0)
+    , m_bad_index(0)
+{
+}
+
+MovePicker::MovePicker(const GameState& state, const HistoryTable& history, Move hash_move)
+    : m_state(state)
+    , m_history(history)
+    , m_stage(Stage::HashMove)
+    , m_hash_move(hash_move)
+    , m_killers({ Move(), Move() })
+    , m_countermove()
+    , m_skip_quiets(!state.isInCheck())
+    , m_index(0)
+    , m_bad_index(0)
+{
+}
+
+bool MovePicker::isLegal(Move move) const
+{
+    if (move == Move()) {
+        return false;
+    }
+    if ((m_state.legalDestinations(move.getSource()) & Bitboards::squareBit(move.getTo())) == Bitboards::Empty) {
+        return false;
+    }
+    // The move from the table may have another kind in this position, like a capture that is now quiet.
+    const PieceType promotion = move.isPromotion() ? move.getPromotion() : PieceType::Queen;
+    return m_state.createMove(move.getSource(), move.getDestiny(), promotion) == move;
+}
+
+bool MovePicker::wasYielded(Move move) const
+{
+    return move == m_hash_move || move == m_killers[0] || move == m_killers[1] || move == m_countermove;
+}
+
+void MovePicker::scoreCaptures()
+{
+    const Board& board = m_state.getBoard();
+    for (std::size_t i = 0; i < m_moves.size(); i++) {
+        const Move move = m_moves[i];
+        int score = 0;
+        if (move.isCapture()) {
+            const PieceType victim = move.isEnPassant() ? PieceType::Pawn : board.pieceAt(move.getTo())->getType();
+            const PieceType attacker = board.pieceAt(move.getFrom())->getType();
+            score = Evaluation::piece_values[static_cast<int>(victim)] * 16 - Evaluation::piece_values[static_cast<int>(attacker)] / 16;
+        }
+        if (move.isPromotion()) {
+            score += Evaluation::piece_values[static_cast<int>(move.getPromotion())];
+        }
+        m_scores[i] = score;
+    }
+}
+
+void MovePicker::scoreQuiets()
+{
+    const PieceColor color = m_state.getTurnColor();
+    for (std::size_t i = 0; i < m_moves.size(); i++) {
+        m_scores[i] = m_history.get(color, m_moves[i]);
+    }
+}
+
+Move MovePicker::pickBest()
+{
+    std::size_t best = m_index;
+    for (std::size_t i = m_index + 1; i < m_moves.size(); i++) {
+        if (m_scores[i] > m_scores[best]) {
+            best = i;
+        }
+    }
+    std::swap(m_moves[m_index], m_moves[best]);
+    std::swap(m_scores[m_index], m_scores[best]);
+    return m_moves[m_index++];
+}
+
+Move MovePicker::next()
+{
+    while (true) {
+        switch (m_stage) {
+        case Stage::HashMove:
+            m_stage = Stage::GenerateCaptures;
+            if (isLegal(m_hash_move) && !(m_skip_quiets && !m_hash_move.isCapture() && !m_hash_move.isPromotion())) {
+                return m_hash_move;
+            }
+            break;
+
+        case Stage::GenerateCaptures:
+            m_state.generateLegalMoves(m_moves, MoveGeneration::Captures);
+            scoreCaptures();
+            m_index = 0;
+            m_stage = Stage::GoodCaptures;
+            break;
+
+        case Stage::GoodCaptures:
+            while (m_index < m_moves.size()) {
+                const Move move = pickBest();
+                if (move == m_hash_move) {
+                    continue;
+                }
+                // Only captures by a piece worth more than its victim can lose material, so only they pay for an
+                // exchange evaluation.
+                const Board& board = m_state.getBoard();
+                if (move.isCapture() && !move.isEnPassant() && !move.isPromotion()
+                    && Evaluation::piece_values[static_cast<int>(board.pieceAt(move.getFrom())->getType())]
+                        > Evaluation::piece_values[static_cast<int>(board.pieceAt(move.getTo())->getType())]
+                    && Evaluation::staticExchange(m_state, move) < 0) {
+                    m_bad_captures.push(move);
+                    continue;
+                }
+                return move;
+            }
+            m_stage = m_skip_quiets ? Stage::BadCaptures : Stage::FirstKiller;
+            break;
+
+        case Stage::FirstKiller:
+            m_stage = Stage::SecondKiller;
+            if (m_killers[0] != m_hash_move && isLegal(m_killers[0])) {
+                return m_killers[0];
+            }
+            break;
+
+        case Stage::SecondKiller:
+            m_stage = Stage::Countermove;
+            if (m_killers[1] != m_hash_move && m_killers[1] != m_killers[0] && isLegal(m_killers[1])) {
+                return m_killers[1];
+            }
+            break;
+
+        case Stage::Countermove:
+            m_stage = Stage::GenerateQuiets;
+            if (m_countermove != m_hash_move && m_countermove != m_killers[0] && m_countermove != m_killers[1] && isLegal(m_countermove)) {
+                return m_countermove;
+            }
+            break;
+
+        case Stage::GenerateQuiets:
+            m_state.generateLegalMoves(m_moves, MoveGeneration::Quiets);
+            scoreQuiets();
+            m_index = 0;
+            m_stage = Stage::Quiets;
+            break;
+
+        case Stage::Quiets:
+            while (m_index < m_moves.size()) {
+                const Move move = pickBest();
+                if (!wasYielded(move)) {
+                    return move;
+                }
+            }
+            m_stage = Stage::BadCaptures;
+            break;
+
+        case Stage::BadCaptures:
+            if (m_bad_index < m_bad_captures.size()) {
+                return m_bad_captures[m_bad_index++];
+            }
+            m_stage = Stage::Done;
+            break;
+
+        case Stage::Done:
+            return Move();
+        }
+    }
+}
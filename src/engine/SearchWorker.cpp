@@ -0,0 +1,353 @@
+#include "../../include/engine/SearchWorker.hpp"
+#include <algorithm>
+
+namespace {
+    /// Mate scores are stored relative to the node, so they stay valid when the position is reached at another ply.
+    int scoreToTable(int score, int ply)
+    {
+        if (score >= Score::MateBound) {
+            return score + ply;
+        } else if (score <= -Score::MateBound) {
+            return score - ply;
+        }
+        return score;
+    }
+
+    int scoreFromTable(int score, int ply)
+    {
+        if (score >= Score::MateBound) {
+            return score - ply;
+        } else if (score <= -Score::MateBound) {
+            return score + ply;
+        }
+        return score;
+    }
+}
+
+SearchWorker::SearchWorker(TranspositionTable& table, std::atomic<bool>& stop, int id)
+    : m_table(table)
+    , m_stop(stop)
+    , m_id(id)
+    , m_state()
+    , m_limits()
+    , m_nodes(0)
+    , m_stopped(false)
+    , m_workers(nullptr)
+{
+}
+
+const SearchResult& SearchWorker::getResult() const
+{
+    return m_result;
+}
+
+std::uint64_t SearchWorker::getNodes() const
+{
+    return m_nodes.load(std::memory_order_relaxed);
+}
+
+void SearchWorker::resetNodes()
+{
+    m_nodes.store(0, std::memory_order_relaxed);
+}
+
+bool SearchWorker::skipsDepth(int depth) const
+{
+    if (m_id == 0) {
+        return false;
+    }
+    // Helpers are spread over the iterations in alternating runs of one to four, each helper at its own phase.
+    constexpr std::array<int, 20> skip_size = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+    constexpr std::array<int, 20> skip_phase = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+    const int i = (m_id - 1) % 20;
+    return (depth + skip_phase[i]) / skip_size[i] % 2 != 0;
+}
+
+void SearchWorker::search(const GameState& state, const SearchLimits& limits,
+    std::chrono::steady_clock::time_point start_time, const std::vector<SearchWorker*>& workers,
+    const IterationCallback& on_iteration)
+{
+    m_state = state;
+    m_limits = limits;
+    m_start_time = start_time;
+    m_workers = &workers;
+    m_stopped = false;
+    m_result = SearchResult();
+    m_history.clear();
+    for (auto& killers : m_killers) {
+        killers.fill(Move());
+    }
+    for (auto& countermoves : m_countermoves) {
+        countermoves.fill(Move());
+    }
+    m_move_stack.fill(Move());
+
+    SearchResult& result = m_result;
+    MoveList root_moves;
+    m_state.generateLegalMoves(root_moves);
+    if (root_moves.empty()) {
+        result.score = m_state.isInCheck() ? -Score::Mate : Score::Draw;
+        return;
+    }
+    // Fall back to any legal move if not even the first iteration completes.
+    result.best_move = root_moves[0];
+
+    for (int depth = 1; depth <= std::min(limits.depth, max_ply); depth++) {
+        if (skipsDepth(depth)) {
+            continue;
+        }
+        int delta = 25;
+        int alpha = -Score::Infinite;
+        int beta = Score::Infinite;
+        if (depth >= 4) {
+            alpha = std::max(result.score - delta, -Score::Infinite);
+            beta = std::min(result.score + delta, Score::Infinite);
+        }
+        int score;
+        while (true) {
+            score = negamax(alpha, beta, depth, 0);
+            if (m_stopped) {
+                break;
+            }
+            // Widen the window on the side that failed and search again.
+            if (score <= alpha) {
+                beta = (alpha + beta) / 2;
+                alpha = std::max(score - delta, -Score::Infinite);
+            } else if (score >= beta) {
+                beta = std::min(score + delta, Score::Infinite);
+            } else {
+                break;
+            }
+            delta += delta;
+        }
+        if (m_stopped) {
+            break;
+        }
+        result.score = score;
+        result.depth = depth;
+        result.pv.assign(m_pv[0].begin(), m_pv[0].begin() + m_pv_length[0]);
+        if (!result.pv.empty()) {
+            result.best_move = result.pv[0];
+        }
+        if (m_id == 0 && on_iteration) {
+            SearchResult report = result;
+            report.nodes = 0;
+            for (const SearchWorker* worker : workers) {
+                report.nodes += worker->getNodes();
+            }
+            on_iteration(report);
+        }
+    }
+    result.nodes = getNodes();
+}
+
+bool SearchWorker::shouldStop()
+{
+    if (m_stopped) {
+        return true;
+    }
+    const std::uint64_t nodes = getNodes();
+    if (m_id == 0 && (nodes & 2047) == 0) {
+        bool out_of_budget = false;
+        if (m_limits.movetime > 0) {
+            const auto elapsed = std::chrono::steady_clock::now() - m_start_time;
+            out_of_budget = elapsed >= std::chrono::milliseconds(m_limits.movetime);
+        }
+        if (m_limits.nodes > 0) {
+            std::uint64_t total_nodes = 0;
+            for (const SearchWorker* worker : *m_workers) {
+                total_nodes += worker->getNodes();
+            }
+            out_of_budget = out_of_budget || total_nodes >= m_limits.nodes;
+        }
+        if (out_of_budget) {
+            m_stop.store(true, std::memory_order_relaxed);
+        }
+    }
+    m_stopped = m_stop.load(std::memory_order_relaxed);
+    return m_stopped;
+}
+
+void SearchWorker::updatePv(int ply, Move move)
+{
+    m_pv[ply][ply] = move;
+    for (int i = ply + 1; i < m_pv_length[ply + 1]; i++) {
+        m_pv[ply][i] = m_pv[ply + 1][i];
+    }
+    m_pv_length[ply] = std::max(m_pv_length[ply + 1], ply + 1);
+}
+
+void SearchWorker::updateQuietStats(Move move, int ply, int depth, const MoveList& tried_quiets)
+{
+    const PieceColor color = m_state.getTurnColor();
+    const int bonus = depth * depth;
+    m_history.update(color, move, bonus);
+    for (const Move tried : tried_quiets) {
+        m_history.update(color, tried, -bonus);
+    }
+    if (m_killers[ply][0] != move) {
+        m_killers[ply][1] = m_killers[ply][0];
+        m_killers[ply][0] = move;
+    }
+    const Move previous = m_move_stack[ply];
+    if (previous != Move()) {
+        m_countermoves[previous.getFrom()][previous.getTo()] = move;
+    }
+}
+
+int SearchWorker::negamax(int alpha, int beta, int depth, int ply)
+{
+    m_pv_length[ply] = ply;
+    if (depth <= 0) {
+        return quiescence(alpha, beta, ply);
+    }
+    if (shouldStop()) {
+        return 0;
+    }
+    // Only this thread writes the counter, so a plain load and store is enough.
+    m_nodes.store(getNodes() + 1, std::memory_order_relaxed);
+
+    const bool pv_node = beta - alpha > 1;
+    if (ply > 0) {
+        if (m_state.getRepetitionCount() > 0 || m_state.getHalfmoveClock() >= 100) {
+            return Score::Draw;
+        }
+        if (ply >= max_ply) {
+            return Evaluation::evaluate(m_state);
+        }
+        // No line from here can beat a mate that was already found closer to the root.
+        alpha = std::max(alpha, -Score::Mate + ply);
+        beta = std::min(beta, Score::Mate - ply - 1);
+        if (alpha >= beta) {
+            return alpha;
+        }
+    }
+
+    Move hash_move;
+    TranspositionTable::Entry entry;
+    if (m_table.probe(m_state.getHash(), entry)) {
+        hash_move = entry.move;
+        if (!pv_node && entry.depth >= depth) {
+            const int score = scoreFromTable(entry.score, ply);
+            if (entry.bound == TranspositionTable::Exact
+                || (entry.bound == TranspositionTable::Lower && score >= beta)
+                || (entry.bound == TranspositionTable::Upper && score <= alpha)) {
+                return score;
+            }
+        }
+    }
+
+    const bool in_check = m_state.isInCheck();
+    if (in_check) {
+        // Check extension: forcing sequences are searched one ply deeper.
+        depth++;
+    }
+
+    const Move previous = m_move_stack[ply];
+    MovePicker picker(m_state, m_history, hash_move, m_killers[ply],
+        previous != Move() ? m_countermoves[previous.getFrom()][previous.getTo()] : Move());
+    // Quiet moves that failed to cause a cutoff, whose history is lowered if a later one does.
+    MoveList tried_quiets;
+    const int original_alpha = alpha;
+    int best_score = -Score::Infinite;
+    Move best_move;
+    int moves_searched = 0;
+    for (Move move = picker.next(); move != Move(); move = picker.next()) {
+        m_move_stack[ply + 1] = move;
+        m_state.makeMove(move);
+        int score;
+        if (moves_searched == 0) {
+            score = -negamax(-beta, -alpha, depth - 1, ply + 1);
+        } else {
+            // Try to prove the move is worse than the best one with a null window, and search it fully otherwise.
+            score = -negamax(-alpha - 1, -alpha, depth - 1, ply + 1);
+            if (score > alpha && score < beta) {
+                score = -negamax(-beta, -alpha, depth - 1, ply + 1);
+            }
+        }
+        m_state.unmakeMove();
+        if (m_stopped) {
+            return 0;
+        }
+        moves_searched++;
+        const bool quiet = !move.isCapture() && !move.isPromotion();
+        if (score > best_score) {
+            best_score = score;
+            best_move = move;
+            if (score > alpha) {
+                alpha = score;
+                updatePv(ply, move);
+                if (alpha >= beta) {
+                    m_result.beta_cutoffs++;
+                    if (moves_searched == 1) {
+                        m_result.first_move_cutoffs++;
+                    }
+                    if (quiet) {
+                        updateQuietStats(move, ply, depth, tried_quiets);
+                    }
+                    break;
+                }
+            }
+        }
+        if (quiet) {
+            tried_quiets.push(move);
+        }
+    }
+    if (moves_searched == 0) {
+        return in_check ? -Score::Mate + ply : Score::Draw;
+    }
+
+    const TranspositionTable::Bound bound = best_score >= beta ? TranspositionTable::Lower
+        : best_score > original_alpha                          ? TranspositionTable::Exact
+                                                               : TranspositionTable::Upper;
+    m_table.store(m_state.getHash(), bound == TranspositionTable::Upper ? Move() : best_move,
+        scoreToTable(best_score, ply), depth, bound);
+    return best_score;
+}
+
+int SearchWorker::quiescence(int alpha, int beta, int ply)
+{
+    m_pv_length[ply] = ply;
+    if (shouldStop()) {
+        return 0;
+    }
+    m_nodes.store(getNodes() + 1, std::memory_order_relaxed);
+    if (ply >= max_ply) {
+        return Evaluation::evaluate(m_state);
+    }
+
+    const bool in_check = m_state.isInCheck();
+    int best_score = -Score::Infinite;
+    // Standing pat is not an option in check, where the picker yields every evasion.
+    if (!in_check) {
+        best_score = Evaluation::evaluate(m_state);
+        if (best_score >= beta) {
+            return best_score;
+        }
+        alpha = std::max(alpha, best_score);
+    }
+
+    MovePicker picker(m_state, m_history, Move());
+    for (Move move = picker.next(); move != Move(); move = picker.next()) {
+        m_state.makeMove(move);
+        const int score = -quiescence(-beta, -alpha, ply + 1);
+        m_state.unmakeMove();
+        if (m_stopped) {
+            return 0;
+        }
+        if (score > best_score) {
+            best_score = score;
+            if (score > alpha) {
+                alpha = score;
+                updatePv(ply, move);
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+    if (in_check && best_score == -Score::Infinite) {
+        return -Score::Mate + ply;
+    }
+    return best_score;
+}
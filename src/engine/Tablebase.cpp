@@ -0,0 +1,308 @@
+#include "../../include/engine/Tablebase.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+    const char magic[8] = { 'C', 'H', 'E', 'S', 'S', 'T', 'B', '1' };
+
+    /// Piece types in the order they are written in names.
+    constexpr PieceType name_order[5] = { PieceType::Queen, PieceType::Rook, PieceType::Bishop, PieceType::Knight, PieceType::Pawn };
+    constexpr char type_letters[6] = { 'K', 'Q', 'B', 'N', 'R', 'P' };
+    /// Rough strength of each piece type, indexed by PieceType, deciding which side is white in canonical names.
+    constexpr int type_strengths[6] = { 0, 9, 3, 3, 5, 1 };
+
+    PieceColor oppositeColor(PieceColor color)
+    {
+        return color == PieceColor::White ? PieceColor::Black : PieceColor::White;
+    }
+
+    std::uint8_t pieceCode(PieceColor color, PieceType type)
+    {
+        return static_cast<std::uint8_t>(static_cast<int>(color) << 3 | static_cast<int>(type));
+    }
+
+    int nameRank(PieceType type)
+    {
+        return static_cast<int>(std::find(std::begin(name_order), std::end(name_order), type) - std::begin(name_order));
+    }
+
+    int materialShift(PieceColor color, PieceType type)
+    {
+        return 4 * (static_cast<int>(color) * 6 + static_cast<int>(type));
+    }
+}
+
+EndgameMaterial EndgameMaterial::fromName(std::string_view name)
+{
+    const std::size_t second_king = name.find('K', 1);
+    if (name.empty() || name[0] != 'K' || second_king == std::string_view::npos || name.size() > max_pieces + 0u) {
+        throw std::invalid_argument("Invalid endgame name: " + std::string(name));
+    }
+    EndgameMaterial material;
+    material.m_codes.fill(0);
+    material.m_codes[0] = pieceCode(PieceColor::White, PieceType::King);
+    material.m_codes[1] = pieceCode(PieceColor::Black, PieceType::King);
+    material.m_size = 2;
+    for (PieceColor color : { PieceColor::White, PieceColor::Black }) {
+        const std::string_view side = color == PieceColor::White ? name.substr(1, second_king - 1) : name.substr(second_king + 1);
+        std::vector<PieceType> types;
+        for (char letter : side) {
+            const char* found = std::find(std::begin(type_letters) + 1, std::end(type_letters), letter);
+            if (found == std::end(type_letters)) {
+                throw std::invalid_argument("Invalid endgame name: " + std::string(name));
+            }
+            types.push_back(static_cast<PieceType>(found - std::begin(type_letters)));
+        }
+        std::sort(types.begin(), types.end(), [](PieceType a, PieceType b) { return nameRank(a) < nameRank(b); });
+        for (PieceType type : types) {
+            material.m_codes[material.m_size++] = pieceCode(color, type);
+        }
+    }
+    return material;
+}
+
+std::uint64_t EndgameMaterial::keyOf(const Board& board, bool flipped)
+{
+    std::uint64_t key = 0;
+    for (PieceColor color : { PieceColor::White, PieceColor::Black }) {
+        for (int type = 0; type < 6; type++) {
+            const std::uint64_t count = Bitboards::popCount(board.pieces(color, static_cast<PieceType>(type)));
+            key += count << materialShift(flipped ? oppositeColor(color) : color, static_cast<PieceType>(type));
+        }
+    }
+    return key;
+}
+
+std::string EndgameMaterial::getName() const
+{
+    std::string name;
+    for (PieceColor color : { PieceColor::White, PieceColor::Black }) {
+        name += 'K';
+        for (int piece = 2; piece < m_size; piece++) {
+            if (colorAt(piece) == color) {
+                name += type_letters[static_cast<int>(typeAt(piece))];
+            }
+        }
+    }
+    return name;
+}
+
+int EndgameMaterial::size() const
+{
+    return m_size;
+}
+
+PieceColor EndgameMaterial::colorAt(int piece) const
+{
+    return static_cast<PieceColor>(m_codes[piece] >> 3);
+}
+
+PieceType EndgameMaterial::typeAt(int piece) const
+{
+    return static_cast<PieceType>(m_codes[piece] & 0x7);
+}
+
+std::uint64_t EndgameMaterial::key() const
+{
+    std::uint64_t key = 0;
+    for (int piece = 0; piece < m_size; piece++) {
+        key += std::uint64_t(1) << materialShift(colorAt(piece), typeAt(piece));
+    }
+    return key;
+}
+
+std::uint64_t EndgameMaterial::positions() const
+{
+    return std::uint64_t(2) << (6 * m_size);
+}
+
+bool EndgameMaterial::isCanonical() const
+{
+    int strengths[2] = { 0, 0 };
+    for (int piece = 2; piece < m_size; piece++) {
+        strengths[static_cast<int>(colorAt(piece))] += type_strengths[static_cast<int>(typeAt(piece))];
+    }
+    if (strengths[0] != strengths[1]) {
+        return strengths[0] > strengths[1];
+    }
+    return getName() >= flipped().getName();
+}
+
+EndgameMaterial EndgameMaterial::flipped() const
+{
+    std::string name = getName();
+    const std::size_t second_king = name.find('K', 1);
+    return fromName(name.substr(second_king) + name.substr(0, second_king));
+}
+
+bool EndgameMaterial::isTrivialDraw() const
+{
+    return m_size == 2 || (m_size == 3 && (typeAt(2) == PieceType::Bishop || typeAt(2) == PieceType::Knight));
+}
+
+std::uint64_t EndgameMaterial::indexOf(const Board& board, PieceColor turn_color, bool flipped) const
+{
+    std::array<int, max_pieces> squares {};
+    Bitboard remaining = Bitboards::Empty;
+    for (int piece = 0; piece < m_size; piece++) {
+        if (piece == 0 || m_codes[piece] != m_codes[piece - 1]) {
+            remaining = board.pieces(flipped ? oppositeColor(colorAt(piece)) : colorAt(piece), typeAt(piece));
+        }
+        const int square = Bitboards::popLsb(remaining);
+        squares[piece] = flipped ? square ^ 56 : square;
+        // Keep the squares of pieces of the same kind in increasing order, which mirroring can break.
+        for (int other = piece; other > 0 && m_codes[other] == m_codes[other - 1] && squares[other] < squares[other - 1]; other--) {
+            std::swap(squares[other], squares[other - 1]);
+        }
+    }
+    return indexOf(squares, flipped ? oppositeColor(turn_color) : turn_color);
+}
+
+std::uint64_t EndgameMaterial::indexOf(const std::array<int, max_pieces>& squares, PieceColor turn_color) const
+{
+    std::uint64_t index = 0;
+    for (int piece = m_size - 1; piece >= 0; piece--) {
+        index = index << 6 | static_cast<std::uint64_t>(squares[piece]);
+    }
+    return index << 1 | (turn_color == PieceColor::Black);
+}
+
+void EndgameMaterial::decode(std::uint64_t index, std::array<int, max_pieces>& squares, PieceColor& turn_color) const
+{
+    turn_color = index & 1 ? PieceColor::Black : PieceColor::White;
+    index >>= 1;
+    for (int piece = 0; piece < m_size; piece++) {
+        squares[piece] = static_cast<int>(index & 63);
+        index >>= 6;
+    }
+}
+
+Tablebase::Tablebase(const std::string& path)
+    : m_file(path)
+    , m_material(EndgameMaterial::fromName("KK"))
+    , m_bits(0)
+{
+    const unsigned char* header = m_file.data();
+    if (m_file.size() < header_size || std::memcmp(header, magic, sizeof(magic)) != 0) {
+        throw std::runtime_error(path + " is not a tablebase");
+    }
+    m_bits = header[9];
+    std::uint64_t entries = 0;
+    for (int i = 7; i >= 0; i--) {
+        entries = entries << 8 | header[16 + i];
+    }
+    // Rebuild the name from the piece codes, which list the kings first.
+    std::string sides[2] = { "K", "K" };
+    for (int piece = 2; piece < std::min<int>(header[8], EndgameMaterial::max_pieces); piece++) {
+        sides[header[10 + piece] >> 3 & 1] += type_letters[std::min(header[10 + piece] & 0x7, 5)];
+    }
+    try {
+        m_material = EndgameMaterial::fromName(sides[0] + sides[1]);
+    } catch (const std::invalid_argument&) {
+        throw std::runtime_error(path + " has an invalid material");
+    }
+    if (m_bits < 1 || m_bits > 16 || entries != m_material.positions()
+        || m_file.size() < header_size + (entries * m_bits + 7) / 8 + 8) {
+        throw std::runtime_error(path + " is truncated or corrupt");
+    }
+}
+
+const EndgameMaterial& Tablebase::getMaterial() const
+{
+    return m_material;
+}
+
+int Tablebase::entry(std::uint64_t index) const
+{
+    // Entries are at most 16 bits, so they span at most 3 bytes. The file is padded so that reading them never
+    // goes past its end.
+    const std::uint64_t bit = index * static_cast<std::uint64_t>(m_bits);
+    const unsigned char* bytes = m_file.data() + header_size + bit / 8;
+    const std::uint32_t value = bytes[0] | bytes[1] << 8 | static_cast<std::uint32_t>(bytes[2]) << 16;
+    return static_cast<int>(value >> (bit % 8) & ((1u << m_bits) - 1));
+}
+
+TablebaseResult Tablebase::resultOf(int entry)
+{
+    if (entry == 0) {
+        return { TablebaseOutcome::Draw, 0 };
+    }
+    const int plies = entry - 1;
+    return { plies % 2 == 1 ? TablebaseOutcome::Win : TablebaseOutcome::Loss, plies };
+}
+
+void Tablebase::write(const std::string& path, const EndgameMaterial& material, const std::vector<std::uint16_t>& entries)
+{
+    int bits = 1;
+    const std::uint16_t largest = entries.empty() ? 0 : *std::max_element(entries.begin(), entries.end());
+    while ((largest >> bits) != 0) {
+        bits++;
+    }
+
+    std::vector<unsigned char> data(header_size + (entries.size() * bits + 7) / 8 + 8, 0);
+    std::memcpy(data.data(), magic, sizeof(magic));
+    data[8] = static_cast<unsigned char>(material.size());
+    data[9] = static_cast<unsigned char>(bits);
+    for (int piece = 0; piece < material.size(); piece++) {
+        data[10 + piece] = pieceCode(material.colorAt(piece), material.typeAt(piece));
+    }
+    for (int i = 0; i < 8; i++) {
+        data[16 + i] = static_cast<unsigned char>(static_cast<std::uint64_t>(entries.size()) >> (8 * i));
+    }
+    for (std::size_t index = 0; index < entries.size(); index++) {
+        const std::uint64_t bit = index * bits;
+        const std::uint32_t value = static_cast<std::uint32_t>(entries[index]) << (bit % 8);
+        for (int byte = 0; byte < 3; byte++) {
+            data[header_size + bit / 8 + byte] |= static_cast<unsigned char>(value >> (8 * byte));
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!file) {
+        throw std::runtime_error("Cannot write the tablebase " + path);
+    }
+}
+
+void Tablebases::add(const std::string& path)
+{
+    m_tables.push_back(std::make_unique<Tablebase>(path));
+    const Tablebase* table = m_tables.back().get();
+    m_by_key[table->getMaterial().key()] = { table, false };
+    // A symmetric material has the same key both ways, and is probed without flipping.
+    m_by_key.emplace(table->getMaterial().flipped().key(), Lookup { table, true });
+}
+
+int Tablebases::addDirectory(const std::string& directory)
+{
+    int count = 0;
+    for (const std::filesystem::directory_entry& file : std::filesystem::directory_iterator(directory)) {
+        if (file.is_regular_file() && file.path().extension() == extension) {
+            add(file.path().string());
+            count++;
+        }
+    }
+    return count;
+}
+
+bool Tablebases::contains(const EndgameMaterial& material) const
+{
+    return m_by_key.count(material.key()) != 0;
+}
+
+std::optional<TablebaseResult> Tablebases::probe(const GameState& state) const
+{
+    if (state.castlingRights() != CastlingRights::None) {
+        return std::nullopt;
+    }
+    const Board& board = state.getBoard();
+    const auto found = m_by_key.find(EndgameMaterial::keyOf(board, false));
+    if (found == m_by_key.end()) {
+        return std::nullopt;
+    }
+    const Lookup& lookup = found->second;
+    return Tablebase::resultOf(lookup.table->entry(lookup.table->getMaterial().indexOf(board, state.getTurnColor(), lookup.flipped)));
+}
@@ -0,0 +1,133 @@
+#include "../../include/engine/TranspositionTable.hpp"
+#include <algorithm>
+
+TranspositionTable::TranspositionTable(std::size_t megabytes)
+    : m_size(0)
+    , m_mask(0)
+    , m_generation(0)
+{
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(std::size_t megabytes)
+{
+    const std::size_t bytes = std::max<std::size_t>(megabytes, 1) * 1024 * 1024;
+    std::size_t buckets = 1;
+    while (buckets * 2 * sizeof(Bucket) <= bytes) {
+        buckets *= 2;
+    }
+    m_buckets.reset(new Bucket[buckets]);
+    m_size = buckets;
+    m_mask = buckets - 1;
+    clear();
+}
+
+void TranspositionTable::clear()
+{
+    for (std::size_t i = 0; i < m_size; i++) {
+        for (Slot& slot : m_buckets[i].slots) {
+            slot.key.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    m_generation = 0;
+}
+
+void TranspositionTable::newSearch()
+{
+    m_generation = (m_generation + 1) & 0x3F;
+}
+
+std::uint64_t TranspositionTable::pack(Move move, int score, int depth, Bound bound, std::uint8_t generation)
+{
+    return static_cast<std::uint64_t>(move.getData())
+        | static_cast<std::uint64_t>(static_cast<std::uint16_t>(static_cast<std::int16_t>(score))) << 16
+        | static_cast<std::uint64_t>(static_cast<std::uint8_t>(depth)) << 32
+        | static_cast<std::uint64_t>(bound) << 40
+        | static_cast<std::uint64_t>(generation) << 42;
+}
+
+TranspositionTable::Entry TranspositionTable::unpack(std::uint64_t data)
+{
+    Entry entry;
+    entry.move = Move(data & 0x3F, (data >> 6) & 0x3F, static_cast<Move::Flag>((data >> 12) & 0xF));
+    entry.score = static_cast<std::int16_t>((data >> 16) & 0xFFFF);
+    entry.depth = depthOf(data);
+    entry.bound = static_cast<Bound>((data >> 40) & 0x3);
+    return entry;
+}
+
+std::uint8_t TranspositionTable::generationOf(std::uint64_t data)
+{
+    return (data >> 42) & 0x3F;
+}
+
+int TranspositionTable::depthOf(std::uint64_t data)
+{
+    return static_cast<std::int8_t>((data >> 32) & 0xFF);
+}
+
+bool TranspositionTable::probe(std::uint64_t key, Entry& entry) const
+{
+    const Bucket& bucket = m_buckets[key & m_mask];
+    for (const Slot& slot : bucket.slots) {
+        const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        if ((slot.key.load(std::memory_order_relaxed) ^ data) == key && data != 0) {
+            entry = unpack(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(std::uint64_t key, Move move, int score, int depth, Bound bound)
+{
+    Bucket& bucket = m_buckets[key & m_mask];
+    Slot* replaced = &bucket.slots[0];
+    std::uint64_t replaced_data = replaced->data.load(std::memory_order_relaxed);
+    bool same_position = false;
+    int lowest_worth = 1 << 30;
+    for (Slot& slot : bucket.slots) {
+        const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        same_position = (slot.key.load(std::memory_order_relaxed) ^ data) == key;
+        if (same_position || data == 0) {
+            replaced = &slot;
+            replaced_data = data;
+            break;
+        }
+        // Every search the entry has survived makes it count as 8 plies shallower.
+        const int age = (m_generation - generationOf(data)) & 0x3F;
+        const int worth = depthOf(data) - 8 * age;
+        if (worth < lowest_worth) {
+            lowest_worth = worth;
+            replaced = &slot;
+            replaced_data = data;
+        }
+    }
+    if (same_position && replaced_data != 0) {
+        const Entry previous = unpack(replaced_data);
+        if (move == Move()) {
+            // Keep the best move found by an earlier search of the same position.
+            move = previous.move;
+        }
+        if (bound != Exact && depth < previous.depth - 2 && generationOf(replaced_data) == m_generation) {
+            return;
+        }
+    }
+    const std::uint64_t data = pack(move, score, depth, bound, m_generation);
+    replaced->key.store(key ^ data, std::memory_order_relaxed);
+    replaced->data.store(data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const
+{
+    const std::size_t sampled = std::min<std::size_t>(m_size, 250);
+    int used = 0;
+    for (std::size_t i = 0; i < sampled; i++) {
+        for (const Slot& slot : m_buckets[i].slots) {
+            const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+            used += data != 0 && generationOf(data) == m_generation;
+        }
+    }
+    return static_cast<int>(used * 1000 / (sampled * 4));
+}
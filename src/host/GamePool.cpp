@@ -0,0 +1,129 @@
+#include "../../include/host/GamePool.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    const CompactPosition& startPosition()
+    {
+        static const CompactPosition position = GameState().toCompact();
+        return position;
+    }
+
+    bool isPromotionPiece(PieceType type)
+    {
+        return type == PieceType::Queen || type == PieceType::Rook || type == PieceType::Bishop || type == PieceType::Knight;
+    }
+}
+
+void GamePool::reserve(std::size_t games)
+{
+    m_positions.reserve(games);
+    m_in_use.reserve(games);
+}
+
+GameId GamePool::create()
+{
+    if (!m_free_ids.empty()) {
+        const GameId id = m_free_ids.back();
+        m_free_ids.pop_back();
+        m_positions[id] = startPosition();
+        m_in_use[id] = true;
+        return id;
+    }
+    m_positions.push_back(startPosition());
+    m_in_use.push_back(true);
+    return static_cast<GameId>(m_positions.size() - 1);
+}
+
+GameId GamePool::create(const GameState& state)
+{
+    const CompactPosition position = state.toCompact();
+    const GameId id = create();
+    m_positions[id] = position;
+    return id;
+}
+
+void GamePool::destroy(GameId id)
+{
+    if (!contains(id)) {
+        throw std::out_of_range("No game with the given ID");
+    }
+    m_in_use[id] = false;
+    m_free_ids.push_back(id);
+}
+
+bool GamePool::contains(GameId id) const
+{
+    return id < m_in_use.size() && m_in_use[id];
+}
+
+std::size_t GamePool::size() const
+{
+    return m_positions.size() - m_free_ids.size();
+}
+
+GameState GamePool::load(GameId id) const
+{
+    if (!contains(id)) {
+        throw std::out_of_range("No game with the given ID");
+    }
+    GameState state;
+    state.loadCompact(m_positions[id]);
+    return state;
+}
+
+void GamePool::store(GameId id, const GameState& state)
+{
+    if (!contains(id)) {
+        throw std::out_of_range("No game with the given ID");
+    }
+    m_positions[id] = state.toCompact();
+}
+
+std::vector<std::uint8_t> GamePool::applyMoves(const std::vector<MoveRequest>& requests, int threads)
+{
+    std::vector<std::uint8_t> results(requests.size(), 0);
+    const std::size_t shard_count = static_cast<std::size_t>(std::max(threads, 1));
+    std::vector<std::vector<std::size_t>> shards(shard_count);
+    for (std::size_t i = 0; i < requests.size(); i++) {
+        shards[requests[i].game % shard_count].push_back(i);
+    }
+
+    std::vector<std::thread> workers;
+    for (std::size_t shard = 1; shard < shard_count; shard++) {
+        workers.emplace_back([&, shard]() { applyShard(requests, shards[shard], results); });
+    }
+    applyShard(requests, shards[0], results);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return results;
+}
+
+void GamePool::applyShard(const std::vector<MoveRequest>& requests, const std::vector<std::size_t>& indices,
+    std::vector<std::uint8_t>& results)
+{
+    GameState state;
+    for (std::size_t index : indices) {
+        const MoveRequest& request = requests[index];
+        if (!contains(request.game) || request.from > 63 || request.to > 63 || !isPromotionPiece(request.promotion)) {
+            continue;
+        }
+        state.loadCompact(m_positions[request.game]);
+        const BoardCoordinate source(Bitboards::columnOf(request.from), Bitboards::rowOf(request.from));
+        const BoardCoordinate destiny(Bitboards::columnOf(request.to), Bitboards::rowOf(request.to));
+        if (!state.isLegalMove(source, destiny)) {
+            continue;
+        }
+        state.move(state.createMove(source, destiny, request.promotion));
+        m_positions[request.game] = state.toCompact();
+        results[index] = 1;
+    }
+}
+
+std::size_t GamePool::memoryUsage() const
+{
+    return m_positions.capacity() * sizeof(CompactPosition) + m_in_use.capacity() * sizeof(std::uint8_t)
+        + m_free_ids.capacity() * sizeof(GameId);
+}
@@ -0,0 +1,86 @@
+#include "../../include/io/MappedFile.hpp"
+#include <stdexcept>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path)
+    : m_data(nullptr)
+    , m_size(0)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+#endif
+{
+#ifdef _WIN32
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER file_size;
+    if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &file_size)) {
+        unmap();
+        throw std::runtime_error("Cannot open " + path);
+    }
+    m_size = static_cast<std::size_t>(file_size.QuadPart);
+    if (m_size != 0) {
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        m_data = m_mapping ? static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        if (m_data == nullptr) {
+            unmap();
+            throw std::runtime_error("Cannot map " + path);
+        }
+    }
+#else
+    const int descriptor = open(path.c_str(), O_RDONLY);
+    struct stat status;
+    if (descriptor < 0 || fstat(descriptor, &status) != 0) {
+        if (descriptor >= 0) {
+            close(descriptor);
+        }
+        throw std::runtime_error("Cannot open " + path);
+    }
+    m_size = static_cast<std::size_t>(status.st_size);
+    if (m_size != 0) {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, descriptor, 0);
+        if (data == MAP_FAILED) {
+            close(descriptor);
+            throw std::runtime_error("Cannot map " + path);
+        }
+        m_data = static_cast<const unsigned char*>(data);
+    }
+    // The mapping stays valid after the descriptor is closed.
+    close(descriptor);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+void MappedFile::unmap()
+{
+#ifdef _WIN32
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+    }
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+#else
+    if (m_data != nullptr) {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
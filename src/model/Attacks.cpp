@@ -0,0 +1,88 @@
+#include "../../include/model/Attacks.hpp"
+
+namespace Attacks {
+    // Spot checks of the tables the compiler builds.
+    static_assert(knight(Square::at(1, 1).index()) == (Square::at(2, 3).bit() | Square::at(3, 2).bit()));
+    static_assert(pawn(PieceColor::White, Square::at(5, 4).index()) == (Square::at(4, 5).bit() | Square::at(6, 5).bit()));
+    static_assert(between(Square::at(1, 1).index(), Square::at(8, 8).index()) == 0x0040201008040200ULL);
+    static_assert(line(Square::at(1, 1).index(), Square::at(2, 2).index()) == 0x8040201008040201ULL);
+    static_assert(line(Square::at(1, 1).index(), Square::at(2, 3).index()) == Bitboards::Empty);
+    static_assert(distance(Square::at(1, 1).index(), Square::at(8, 5).index()) == 7);
+    static_assert(Tables::rook_magics[0].mask == 0x000101010101017EULL && Tables::rook_magics[0].shift == 52);
+    static_assert(Tables::slider_attacks_size == 102400 + 5248);
+
+    namespace {
+        /// The attack sets of the sliders, and how many of them a magic mapped to an index holding a different one.
+        struct SliderTable {
+            std::array<Bitboard, Tables::slider_attacks_size> attacks;
+            int collisions;
+        };
+
+        /**
+         * @brief Returns the index of an occupancy among the attack sets of a square, like Magic::index but usable by
+         *        the compiler.
+         */
+        constexpr unsigned tableIndex(const Magic& magic, Bitboard occupied)
+        {
+#if defined(CHESS_USE_PEXT)
+            // Gathers the bits of the mask into the lowest bits, in order, like PEXT does.
+            unsigned index = 0;
+            int bit = 0;
+            for (Bitboard mask = magic.mask; mask != Bitboards::Empty; mask &= mask - 1, bit++) {
+                if (occupied & mask & (0 - mask)) {
+                    index |= 1U << bit;
+                }
+            }
+            return index;
+#else
+            return static_cast<unsigned>(((occupied & magic.mask) * magic.magic) >> magic.shift);
+#endif
+        }
+
+        constexpr Bitboard slidingAttacks(const std::array<Direction, 4>& directions, int square, Bitboard occupied)
+        {
+            Bitboard attacks = Bitboards::Empty;
+            for (Direction direction : directions) {
+                attacks |= ray(direction, square, occupied);
+            }
+            return attacks;
+        }
+
+        /**
+         * @brief Writes the attack sets of a slider on every square for every occupancy of its masks.
+         */
+        constexpr void fillAttacks(SliderTable& table, const std::array<Magic, 64>& magics, const std::array<Direction, 4>& directions)
+        {
+            for (int square = 0; square < 64; square++) {
+                const Magic& magic = magics[square];
+                // Enumerate every subset of the mask.
+                Bitboard subset = Bitboards::Empty;
+                do {
+                    const unsigned index = magic.offset + tableIndex(magic, subset);
+                    const Bitboard attacks = slidingAttacks(directions, square, subset);
+                    // Sliders always attack some square, so an empty entry was not written yet.
+                    if (table.attacks[index] != Bitboards::Empty && table.attacks[index] != attacks) {
+                        table.collisions++;
+                    }
+                    table.attacks[index] = attacks;
+                    subset = (subset - magic.mask) & magic.mask;
+                } while (subset != Bitboards::Empty);
+            }
+        }
+
+        constexpr SliderTable sliderTable()
+        {
+            SliderTable table {};
+            fillAttacks(table, Tables::rook_magics, Generation::rook_directions);
+            fillAttacks(table, Tables::bishop_magics, Generation::bishop_directions);
+            return table;
+        }
+
+        constexpr SliderTable slider_table = sliderTable();
+        static_assert(slider_table.collisions == 0, "A magic maps different attack sets to the same index");
+    }
+
+    namespace Tables {
+        constexpr std::array<Bitboard, slider_attacks_size> slider_attacks = slider_table.attacks;
+    }
+}
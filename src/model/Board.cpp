@@ -1,34 +1,125 @@
 #include "../../include/model/Board.hpp"
 #include <stdexcept>
 
+Board::SquareReference::PieceHandle::PieceHandle(Board& board, int square)
+    : m_board(board)
+    , m_square(square)
+{
+}
+
+Board::SquareReference::PieceHandle::~PieceHandle()
+{
+    m_board.resyncSquare(m_square);
+}
+
+Piece* Board::SquareReference::PieceHandle::operator->() const
+{
+    return &*m_board.m_mailbox[m_square];
+}
+
+Board::SquareReference::SquareReference(Board& board, int square)
+    : m_board(board)
+    , m_square(square)
+{
+}
+
+Board::SquareReference& Board::SquareReference::operator=(const SquareReference& that)
+{
+    return *this = static_cast<std::optional<Piece>>(that);
+}
+
+Board::SquareReference& Board::SquareReference::operator=(const std::optional<Piece>& piece)
+{
+    if (m_board.isOccupied(m_square)) {
+        m_board.removePiece(m_square);
+    }
+    if (piece.has_value()) {
+        m_board.putPiece(m_square, piece.value());
+    }
+    return *this;
+}
+
+void Board::SquareReference::reset()
+{
+    if (m_board.isOccupied(m_square)) {
+        m_board.removePiece(m_square);
+    }
+}
+
+bool Board::SquareReference::has_value() const
+{
+    return m_board.isOccupied(m_square);
+}
+
+Board::SquareReference::operator bool() const
+{
+    return has_value();
+}
+
+Board::SquareReference::operator std::optional<Piece>() const
+{
+    return m_board.pieceAt(m_square);
+}
+
+Board::SquareReference::PieceHandle Board::SquareReference::operator->() const
+{
+    return PieceHandle(m_board, m_square);
+}
+
 Board::Board()
-    : m_board({ Piece(PieceColor::Black, PieceType::Rook), Piece(PieceColor::Black, PieceType::Pawn), std::nullopt, std::nullopt, std::nullopt, std::nullopt, Piece(PieceColor::White, PieceType::Pawn), Piece(PieceColor::White, PieceType::Rook),
-          Piece(PieceColor::Black, PieceType::Knight), Piece(PieceColor::Black, PieceType::Pawn), std::nullopt, std::nullopt, std::nullopt, std::nullopt, Piece(PieceColor::White, PieceType::Pawn), Piece(PieceColor::White, PieceType::Knight),
-          Piece(PieceColor::Black, PieceType::Bishop), Piece(PieceColor::Black, PieceType::Pawn), std::nullopt, std::nullopt, std::nullopt, std::nullopt, Piece(PieceColor::White, PieceType::Pawn), Piece(PieceColor::White, PieceType::Bishop),
-          Piece(PieceColor::Black, PieceType::Queen), Piece(PieceColor::Black, PieceType::Pawn), std::nullopt, std::nullopt, std::nullopt, std::nullopt, Piece(PieceColor::White, PieceType::Pawn), Piece(PieceColor::White, PieceType::Queen),
-          Piece(PieceColor::Black, PieceType::King), Piece(PieceColor::Black, PieceType::Pawn), std::nullopt, std::nullopt, std::nullopt, std::nullopt, Piece(PieceColor::White, PieceType::Pawn), Piece(PieceColor::White, PieceType::King),
-          Piece(PieceColor::Black, PieceType::Bishop), Piece(PieceColor::Black, PieceType::Pawn), std::nullopt, std::nullopt, std::nullopt, std::nullopt, Piece(PieceColor::White, PieceType::Pawn), Piece(PieceColor::White, PieceType::Bishop),
-          Piece(PieceColor::Black, PieceType::Knight), Piece(PieceColor::Black, PieceType::Pawn), std::nullopt, std::nullopt, std::nullopt, std::nullopt, Piece(PieceColor::White, PieceType::Pawn), Piece(PieceColor::White, PieceType::Knight),
-          Piece(PieceColor::Black, PieceType::Rook), Piece(PieceColor::Black, PieceType::Pawn), std::nullopt, std::nullopt, std::nullopt, std::nullopt, Piece(PieceColor::White, PieceType::Pawn), Piece(PieceColor::White, PieceType::Rook) })
 {
+    clear();
+    const PieceType back_rank[8] = { PieceType::Rook, PieceType::Knight, PieceType::Bishop, PieceType::Queen,
+        PieceType::King, PieceType::Bishop, PieceType::Knight, PieceType::Rook };
+    for (int col = BoardColumn::A; col <= BoardColumn::H; col++) {
+        putPiece(Bitboards::squareOf(col, 1), Piece(PieceColor::White, back_rank[col - 1]));
+        putPiece(Bitboards::squareOf(col, 2), Piece(PieceColor::White, PieceType::Pawn));
+        putPiece(Bitboards::squareOf(col, 7), Piece(PieceColor::Black, PieceType::Pawn));
+        putPiece(Bitboards::squareOf(col, 8), Piece(PieceColor::Black, back_rank[col - 1]));
+    }
+}
+
+void Board::clear()
+{
+    m_pieces_by_type.fill(Bitboards::Empty);
+    m_pieces_by_color.fill(Bitboards::Empty);
+    m_occupied = Bitboards::Empty;
+    m_mailbox.fill(std::nullopt);
 }
 
-std::optional<Piece>& Board::accessBoard(const BoardCoordinate pos)
+void Board::resyncSquare(int square)
+{
+    const Bitboard bit = Bitboards::squareBit(square);
+    for (Bitboard& pieces : m_pieces_by_type) {
+        pieces &= ~bit;
+    }
+    for (Bitboard& pieces : m_pieces_by_color) {
+        pieces &= ~bit;
+    }
+    m_occupied &= ~bit;
+    if (m_mailbox[square].has_value()) {
+        const Piece piece = m_mailbox[square].value();
+        m_mailbox[square].reset();
+        putPiece(square, piece);
+    }
+}
+
+Board::SquareReference Board::accessBoard(const BoardCoordinate pos)
 {
     return accessBoard(pos.getCol(), pos.getRow());
 }
 
-std::optional<Piece>& Board::accessBoard(short int col, short int row)
+Board::SquareReference Board::accessBoard(short int col, short int row)
 {
     if (col > 8 || col < 1 || row > 8 || row < 1) {
         throw std::out_of_range("Out of board's range.");
     }
-    return m_board[(col - 1) * 8 + (8 - row)];
+    return SquareReference(*this, Bitboards::squareOf(col, row));
 }
 
 std::optional<Piece> Board::readBoard(const BoardCoordinate pos) const
 {
-    return readBoard(pos.getCol(), pos.getRow());
+    return m_mailbox[pos.toSquare().index()];
 }
 
 std::optional<Piece> Board::readBoard(short int col, short int row) const
@@ -36,5 +127,5 @@ std::optional<Piece> Board::readBoard(short int col, short int row) const
     if (col > 8 || col < 1 || row > 8 || row < 1) {
         return std::nullopt;
     }
-    return m_board[(col - 1) * 8 + (8 - row)];
-}
\ No newline at end of file
+    return m_mailbox[Bitboards::squareOf(col, row)];
+}
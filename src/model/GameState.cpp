@@ -1,61 +1,542 @@
 #include "../../include/model/GameState.hpp"
+#include "../../include/model/Attacks.hpp"
+#include "../../include/model/Stats.hpp"
+#include "../../include/model/Zobrist.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
 #include <stdexcept>
 
+namespace {
+    PieceColor oppositeColor(PieceColor color)
+    {
+        return color == PieceColor::White ? PieceColor::Black : PieceColor::White;
+    }
+
+    Move::Flag promotionFlag(PieceType promotion, bool is_capture)
+    {
+        int flag = is_capture ? Move::KnightPromotionCapture : Move::KnightPromotion;
+        switch (promotion) {
+        case PieceType::Bishop:
+            flag += 1;
+            break;
+        case PieceType::Rook:
+            flag += 2;
+            break;
+        case PieceType::Queen:
+            flag += 3;
+            break;
+        default:
+            break;
+        }
+        return static_cast<Move::Flag>(flag);
+    }
+
+    /// Squares whose pieces decide the castling rights.
+    constexpr Bitboard castling_squares = Bitboards::squareBit(Bitboards::squareOf(BoardColumn::A, 1))
+        | Bitboards::squareBit(Bitboards::squareOf(BoardColumn::E, 1)) | Bitboards::squareBit(Bitboards::squareOf(BoardColumn::H, 1))
+        | Bitboards::squareBit(Bitboards::squareOf(BoardColumn::A, 8)) | Bitboards::squareBit(Bitboards::squareOf(BoardColumn::E, 8))
+        | Bitboards::squareBit(Bitboards::squareOf(BoardColumn::H, 8));
+
+    /// FEN letter of each black piece, indexed by PieceType. White pieces use the uppercase letter.
+    constexpr char piece_letters[] = { 'k', 'q', 'b', 'n', 'r', 'p' };
+
+    /**
+     * @brief Returns the next space separated field of a FEN string and advances past it, or an empty view at the end.
+     */
+    std::string_view nextField(std::string_view& fen)
+    {
+        const std::size_t start = std::min(fen.find_first_not_of(' '), fen.size());
+        const std::size_t end = std::min(fen.find(' ', start), fen.size());
+        const std::string_view field = fen.substr(start, end - start);
+        fen.remove_prefix(end);
+        return field;
+    }
+
+    /**
+     * @brief Returns a piece as it is placed by a FEN or compact position, which do not say whether it has moved.
+     * @details Kings and rooks count as moved until markCastlingPieces says otherwise, and pawns count as moved once
+     *          they have left their starting row.
+     */
+    Piece placedPiece(PieceColor color, PieceType type, int square)
+    {
+        Piece piece(color, type);
+        const int start_row = color == PieceColor::White ? 2 : 7;
+        if (type == PieceType::King || type == PieceType::Rook || (type == PieceType::Pawn && Bitboards::rowOf(square) != start_row)) {
+            piece.setAsMoved();
+        }
+        return piece;
+    }
+
+    /**
+     * @brief Marks the kings and rooks that keep the given CastlingRights as not moved.
+     * @details Throws std::invalid_argument if one of them is not on its starting square.
+     */
+    void markCastlingPieces(Board& board, int castling_rights)
+    {
+        for (int right : { CastlingRights::WhiteKingSide, CastlingRights::WhiteQueenSide, CastlingRights::BlackKingSide, CastlingRights::BlackQueenSide }) {
+            if (!(castling_rights & right)) {
+                continue;
+            }
+            const bool is_white = right & (CastlingRights::WhiteKingSide | CastlingRights::WhiteQueenSide);
+            const PieceColor color = is_white ? PieceColor::White : PieceColor::Black;
+            const int back_row = is_white ? 1 : 8;
+            const int rook_column = right & (CastlingRights::WhiteKingSide | CastlingRights::BlackKingSide) ? BoardColumn::H : BoardColumn::A;
+            const int king_square = Bitboards::squareOf(BoardColumn::E, back_row);
+            const int rook_square = Bitboards::squareOf(rook_column, back_row);
+            if (!(board.pieces(color, PieceType::King) & Bitboards::squareBit(king_square))
+                || !(board.pieces(color, PieceType::Rook) & Bitboards::squareBit(rook_square))) {
+                throw std::invalid_argument("Castling rights without king and rook in place");
+            }
+            board.removePiece(king_square);
+            board.putPiece(king_square, Piece(color, PieceType::King));
+            board.removePiece(rook_square);
+            board.putPiece(rook_square, Piece(color, PieceType::Rook));
+        }
+    }
+
+    int parseCounter(std::string_view field, int default_value)
+    {
+        if (field.empty()) {
+            return default_value;
+        }
+        int value = 0;
+        const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+        if (error != std::errc() || end != field.data() + field.size() || value < 0) {
+            throw std::invalid_argument("Invalid move counter in FEN");
+        }
+        return value;
+    }
+
+    void pushPawnMove(MoveList& moves, int from, int to, bool is_capture)
+    {
+        const int row = Bitboards::rowOf(to);
+        if (row == 1 || row == 8) {
+            for (PieceType promotion : { PieceType::Queen, PieceType::Rook, PieceType::Bishop, PieceType::Knight }) {
+                moves.push(Move(from, to, promotionFlag(promotion, is_capture)));
+            }
+        } else {
+            moves.push(Move(from, to, is_capture ? Move::Capture : Move::Quiet));
+        }
+    }
+}
+
 GameState::GameState()
     : m_turn_color(PieceColor::White)
     , m_board()
     , pawn_double_moved_last_turn(std::nullopt)
+    , m_castling_rights(CastlingRights::None)
+    , m_hash(0)
+    , m_piece_square_score()
+    , m_phase(0)
+    , m_halfmove_clock(0)
+    , m_fullmove_number(1)
+    , m_generation(0)
+    , m_undo_size(0)
+    , m_king_squares()
+    , m_check_info_valid(false)
+    , m_checkers(Bitboards::Empty)
+    , m_pinned(Bitboards::Empty)
 {
+    initializeDerivedState();
 }
 
-std::optional<Piece>& GameState::accessBoard(short int col, short int row)
+GameState::GameState(const Board& board, PieceColor turn_color, std::optional<BoardCoordinate> double_moved_pawn)
+    : m_turn_color(turn_color)
+    , m_board(board)
+    , pawn_double_moved_last_turn(double_moved_pawn)
+    , m_castling_rights(CastlingRights::None)
+    , m_hash(0)
+    , m_piece_square_score()
+    , m_phase(0)
+    , m_halfmove_clock(0)
+    , m_fullmove_number(1)
+    , m_generation(0)
+    , m_undo_size(0)
+    , m_king_squares()
+    , m_check_info_valid(false)
+    , m_checkers(Bitboards::Empty)
+    , m_pinned(Bitboards::Empty)
 {
-    return m_board.accessBoard(col, row);
+    initializeDerivedState();
 }
 
-std::optional<Piece> GameState::readBoard(BoardCoordinate pos) const
+GameState GameState::fromFEN(std::string_view fen)
 {
-    return m_board.readBoard(pos);
+    GameState state;
+    state.loadFEN(fen);
+    return state;
 }
 
-std::optional<Piece> GameState::readBoard(short int col, short int row) const
+void GameState::loadFEN(std::string_view fen)
 {
-    return m_board.readBoard(col, row);
+    Board board;
+    board.clear();
+    const std::string_view placement = nextField(fen);
+    int row = 8;
+    int col = 1;
+    for (const char c : placement) {
+        if (c == '/') {
+            if (col != 9 || row == 1) {
+                throw std::invalid_argument("Invalid row in FEN");
+            }
+            row--;
+            col = 1;
+        } else if (c >= '1' && c <= '8') {
+            col += c - '0';
+            if (col > 9) {
+                throw std::invalid_argument("Invalid row in FEN");
+            }
+        } else {
+            const char* letter = std::find(std::begin(piece_letters), std::end(piece_letters), c | 0x20);
+            if (letter == std::end(piece_letters) || col > 8) {
+                throw std::invalid_argument("Invalid piece placement in FEN");
+            }
+            const PieceColor color = c < 'a' ? PieceColor::White : PieceColor::Black;
+            const PieceType type = static_cast<PieceType>(letter - std::begin(piece_letters));
+            if (type == PieceType::Pawn && (row == 1 || row == 8)) {
+                throw std::invalid_argument("Pawn on the first or last row in FEN");
+            }
+            const int square = Bitboards::squareOf(col++, row);
+            board.putPiece(square, placedPiece(color, type, square));
+        }
+    }
+    if (row != 1 || col != 9) {
+        throw std::invalid_argument("Invalid piece placement in FEN");
+    }
+    for (PieceColor color : { PieceColor::White, PieceColor::Black }) {
+        if (Bitboards::popCount(board.pieces(color, PieceType::King)) != 1) {
+            // Checked before anything changes, so that a failed load leaves the game as it was.
+            throw std::invalid_argument("FEN must have exactly one king of each color");
+        }
+    }
+
+    const std::string_view turn = nextField(fen);
+    if (turn != "w" && turn != "b") {
+        throw std::invalid_argument("Invalid side to move in FEN");
+    }
+    const PieceColor turn_color = turn == "w" ? PieceColor::White : PieceColor::Black;
+
+    const std::string_view castling = nextField(fen);
+    if (castling.empty()) {
+        throw std::invalid_argument("Missing castling rights in FEN");
+    }
+    int castling_rights = CastlingRights::None;
+    if (castling != "-") {
+        for (const char c : castling) {
+            switch (c) {
+            case 'K':
+                castling_rights |= CastlingRights::WhiteKingSide;
+                break;
+            case 'Q':
+                castling_rights |= CastlingRights::WhiteQueenSide;
+                break;
+            case 'k':
+                castling_rights |= CastlingRights::BlackKingSide;
+                break;
+            case 'q':
+                castling_rights |= CastlingRights::BlackQueenSide;
+                break;
+            default:
+                throw std::invalid_argument("Invalid castling rights in FEN");
+            }
+        }
+    }
+    markCastlingPieces(board, castling_rights);
+
+    std::optional<BoardCoordinate> double_moved_pawn;
+    const std::string_view en_passant = nextField(fen);
+    if (en_passant.empty()) {
+        throw std::invalid_argument("Missing en passant square in FEN");
+    }
+    if (en_passant != "-") {
+        // FEN gives the square behind the pawn; the game tracks the pawn itself.
+        const int target_row = turn_color == PieceColor::White ? 6 : 3;
+        const int pawn_row = turn_color == PieceColor::White ? 5 : 4;
+        if (en_passant.size() != 2 || en_passant[0] < 'a' || en_passant[0] > 'h' || en_passant[1] - '0' != target_row) {
+            throw std::invalid_argument("Invalid en passant square in FEN");
+        }
+        const int en_passant_column = en_passant[0] - 'a' + 1;
+        if (!(board.pieces(oppositeColor(turn_color), PieceType::Pawn)
+                & Bitboards::squareBit(Bitboards::squareOf(en_passant_column, pawn_row)))) {
+            throw std::invalid_argument("En passant square without a double moved pawn in FEN");
+        }
+        double_moved_pawn = BoardCoordinate(en_passant_column, pawn_row);
+    }
+
+    const int halfmove_clock = parseCounter(nextField(fen), 0);
+    const int fullmove_number = std::max(parseCounter(nextField(fen), 1), 1);
+    if (!nextField(fen).empty()) {
+        throw std::invalid_argument("Unexpected trailing fields in FEN");
+    }
+
+    m_turn_color = turn_color;
+    m_board = board;
+    pawn_double_moved_last_turn = double_moved_pawn;
+    m_halfmove_clock = halfmove_clock;
+    m_fullmove_number = fullmove_number;
+    initializeDerivedState();
 }
 
-bool GameState::existInterrumptions(BoardCoordinate source, BoardCoordinate destiny) const
+void GameState::initializeDerivedState()
 {
-    if (source.getCol() == destiny.getCol()) {
-        // If it is a column, check all the squares in the column between the squares.
-        const int modifier = source.getRow() < destiny.getRow() ? 1 : -1;
-        for (int i = source.getRow() + modifier; i != destiny.getRow(); i += modifier) {
-            if (readBoard(source.getCol(), i).has_value()) {
-                return true;
-            }
+    m_generation++;
+    for (PieceColor color : { PieceColor::White, PieceColor::Black }) {
+        const Bitboard king = m_board.pieces(color, PieceType::King);
+        if (Bitboards::popCount(king) != 1) {
+            throw std::invalid_argument("The board must have exactly one king of each color");
         }
-        return false;
-    } else if (source.getRow() == destiny.getRow()) {
-        // If it is a row, check all the squares in the row between the squares.
-        const int modifier = source.getCol() < destiny.getCol() ? 1 : -1;
-        for (int i = source.getCol() + modifier; i != destiny.getCol(); i += modifier) {
-            if (readBoard(i, source.getRow()).has_value()) {
-                return true;
+        m_king_squares[static_cast<int>(color)] = Bitboards::lsb(king);
+    }
+    m_castling_rights = computeCastlingRights();
+    m_hash = computeHash();
+    m_piece_square_score = computePieceSquareScore();
+    m_phase = 0;
+    for (Bitboard pieces = m_board.occupied(); pieces != Bitboards::Empty;) {
+        m_phase += PieceSquare::phaseWeight(m_board.pieceAt(Bitboards::popLsb(pieces))->getType());
+    }
+    m_history.clear();
+    m_history.push_back({ m_hash, 0 });
+    m_undo_size = 0;
+    m_check_info_valid = false;
+}
+
+CompactPosition GameState::toCompact() const
+{
+    CompactPosition position {};
+    position.occupied = m_board.occupied();
+    if (Bitboards::popCount(position.occupied) > 32) {
+        throw std::length_error("A compact position holds at most 32 pieces");
+    }
+    int index = 0;
+    for (Bitboard remaining = position.occupied; remaining != Bitboards::Empty; index++) {
+        const Piece& piece = m_board.pieceAt(Bitboards::popLsb(remaining)).value();
+        const int code = static_cast<int>(piece.getColor()) << 3 | static_cast<int>(piece.getType());
+        position.pieces[index / 2] |= static_cast<std::uint8_t>(code << (4 * (index % 2)));
+    }
+    position.halfmove_clock = static_cast<std::uint16_t>(std::min(m_halfmove_clock, 0xFFFF));
+    position.fullmove_number = static_cast<std::uint16_t>(std::min(m_fullmove_number, 0xFFFF));
+    position.flags = static_cast<std::uint8_t>((m_turn_color == PieceColor::Black) | m_castling_rights << 1);
+    position.en_passant_column = pawn_double_moved_last_turn.has_value() ? pawn_double_moved_last_turn->getCol() : 0;
+    return position;
+}
+
+void GameState::loadCompact(const CompactPosition& position)
+{
+    m_board.clear();
+    int index = 0;
+    for (Bitboard remaining = position.occupied; remaining != Bitboards::Empty; index++) {
+        const int square = Bitboards::popLsb(remaining);
+        const int code = position.pieces[index / 2] >> (4 * (index % 2)) & 0xF;
+        m_board.putPiece(square, placedPiece(static_cast<PieceColor>(code >> 3), static_cast<PieceType>(code & 0x7), square));
+    }
+    markCastlingPieces(m_board, position.flags >> 1 & 0xF);
+    m_turn_color = position.flags & 1 ? PieceColor::Black : PieceColor::White;
+    pawn_double_moved_last_turn.reset();
+    if (position.en_passant_column != 0) {
+        pawn_double_moved_last_turn = BoardCoordinate(Square::at(position.en_passant_column, m_turn_color == PieceColor::White ? 5 : 4));
+    }
+    m_halfmove_clock = position.halfmove_clock;
+    m_fullmove_number = position.fullmove_number;
+    initializeDerivedState();
+}
+
+std::string GameState::toFEN() const
+{
+    std::string fen;
+    fen.reserve(90);
+    for (int row = 8; row >= 1; row--) {
+        int empty_squares = 0;
+        for (int col = 1; col <= 8; col++) {
+            const std::optional<Piece>& piece = m_board.pieceAt(Bitboards::squareOf(col, row));
+            if (!piece.has_value()) {
+                empty_squares++;
+                continue;
             }
-        }
-        return false;
-    } else if (abs(source.getRow() - destiny.getRow()) == abs(source.getCol() - destiny.getCol())) {
-        // If it is a diagonal, check all the squares in the diagonal between the squares.
-        const int modifierX = source.getCol() < destiny.getCol() ? 1 : -1;
-        const int modifierY = source.getRow() < destiny.getRow() ? 1 : -1;
-        for (int i = source.getCol() + modifierX, j = source.getRow() + modifierY; i != destiny.getCol() || j != destiny.getRow(); i += modifierX, j += modifierY) {
-            if (readBoard(i, j).has_value()) {
-                return true;
+            if (empty_squares > 0) {
+                fen += static_cast<char>('0' + empty_squares);
+                empty_squares = 0;
             }
+            const char letter = piece_letters[static_cast<int>(piece->getType())];
+            fen += piece->getColor() == PieceColor::White ? static_cast<char>(letter - 'a' + 'A') : letter;
+        }
+        if (empty_squares > 0) {
+            fen += static_cast<char>('0' + empty_squares);
+        }
+        if (row > 1) {
+            fen += '/';
         }
-        return false;
+    }
+
+    fen += m_turn_color == PieceColor::White ? " w " : " b ";
+    if (m_castling_rights == CastlingRights::None) {
+        fen += '-';
+    }
+    if (m_castling_rights & CastlingRights::WhiteKingSide) {
+        fen += 'K';
+    }
+    if (m_castling_rights & CastlingRights::WhiteQueenSide) {
+        fen += 'Q';
+    }
+    if (m_castling_rights & CastlingRights::BlackKingSide) {
+        fen += 'k';
+    }
+    if (m_castling_rights & CastlingRights::BlackQueenSide) {
+        fen += 'q';
+    }
+
+    fen += ' ';
+    if (pawn_double_moved_last_turn.has_value()) {
+        fen += static_cast<char>('a' + pawn_double_moved_last_turn->getCol() - 1);
+        fen += pawn_double_moved_last_turn->getRow() == 4 ? '3' : '6';
     } else {
+        fen += '-';
+    }
+    fen += ' ';
+    fen += std::to_string(m_halfmove_clock);
+    fen += ' ';
+    fen += std::to_string(m_fullmove_number);
+    return fen;
+}
+
+std::optional<Piece> GameState::readBoard(BoardCoordinate pos) const
+{
+    return m_board.readBoard(pos);
+}
+
+std::optional<Piece> GameState::readBoard(short int col, short int row) const
+{
+    return m_board.readBoard(col, row);
+}
+
+PieceColor GameState::getTurnColor() const
+{
+    return m_turn_color;
+}
+
+const Board& GameState::getBoard() const
+{
+    return m_board;
+}
+
+std::optional<BoardCoordinate> GameState::getDoubleMovedPawn() const
+{
+    return pawn_double_moved_last_turn;
+}
+
+std::uint64_t GameState::getGeneration() const
+{
+    return m_generation;
+}
+
+int GameState::castlingRights() const
+{
+    return m_castling_rights;
+}
+
+int GameState::computeCastlingRights() const
+{
+    return (canCastle(PieceColor::White, BoardColumn::H) ? CastlingRights::WhiteKingSide : CastlingRights::None)
+        | (canCastle(PieceColor::White, BoardColumn::A) ? CastlingRights::WhiteQueenSide : CastlingRights::None)
+        | (canCastle(PieceColor::Black, BoardColumn::H) ? CastlingRights::BlackKingSide : CastlingRights::None)
+        | (canCastle(PieceColor::Black, BoardColumn::A) ? CastlingRights::BlackQueenSide : CastlingRights::None);
+}
+
+std::uint64_t GameState::getHash() const
+{
+    return m_hash;
+}
+
+std::uint64_t GameState::computeHash() const
+{
+    std::uint64_t hash = 0;
+    for (Bitboard pieces = m_board.occupied(); pieces != Bitboards::Empty;) {
+        const int square = Bitboards::popLsb(pieces);
+        hash ^= Zobrist::piece(m_board.pieceAt(square).value(), square);
+    }
+    if (m_turn_color == PieceColor::Black) {
+        hash ^= Zobrist::keys.black_to_move;
+    }
+    return hash ^ Zobrist::keys.castling[computeCastlingRights()] ^ enPassantKey();
+}
+
+TaperedScore GameState::getPieceSquareScore() const
+{
+    return m_piece_square_score;
+}
+
+TaperedScore GameState::computePieceSquareScore() const
+{
+    TaperedScore score;
+    for (Bitboard pieces = m_board.occupied(); pieces != Bitboards::Empty;) {
+        const int square = Bitboards::popLsb(pieces);
+        score += PieceSquare::value(m_board.pieceAt(square).value(), square);
+    }
+    return score;
+}
+
+int GameState::getPhase() const
+{
+    return m_phase;
+}
+
+std::uint64_t GameState::enPassantKey() const
+{
+    if (!pawn_double_moved_last_turn.has_value()) {
+        return 0;
+    }
+    const int pawn_square = Bitboards::squareOf(pawn_double_moved_last_turn->getCol(), pawn_double_moved_last_turn->getRow());
+    const int target = pawn_square + (m_turn_color == PieceColor::White ? 8 : -8);
+    if ((Attacks::pawn(oppositeColor(m_turn_color), target) & m_board.pieces(m_turn_color, PieceType::Pawn)) == Bitboards::Empty) {
+        return 0;
+    }
+    return Zobrist::keys.en_passant_column[pawn_double_moved_last_turn->getCol() - 1];
+}
+
+int GameState::getHalfmoveClock() const
+{
+    return m_halfmove_clock;
+}
+
+int GameState::getFullmoveNumber() const
+{
+    return m_fullmove_number;
+}
+
+int GameState::getRepetitionCount() const
+{
+    return m_history.back().repetitions;
+}
+
+bool GameState::isThreefoldRepetition() const
+{
+    return getRepetitionCount() >= 2;
+}
+
+void GameState::pushHistory()
+{
+    int repetitions = 0;
+    const int current = static_cast<int>(m_history.size());
+    const int oldest = std::max(0, current - m_halfmove_clock);
+    for (int i = current - 2; i >= oldest; i -= 2) {
+        if (m_history[i].hash == m_hash) {
+            repetitions = m_history[i].repetitions + 1;
+            break;
+        }
+    }
+    m_history.push_back({ m_hash, repetitions });
+}
+
+bool GameState::existInterrumptions(BoardCoordinate source, BoardCoordinate destiny) const
+{
+    CHESS_STATS_TIMER(ExistInterrumptions);
+    const int source_square = source.toSquare().index();
+    const int destiny_square = destiny.toSquare().index();
+    if (Attacks::line(source_square, destiny_square) == Bitboards::Empty) {
+        // The squares are not in a column, row or diagonal.
         return true;
     }
+    return (Attacks::between(source_square, destiny_square) & m_board.occupied()) != Bitboards::Empty;
 }
 
 bool GameState::belongsToCurrentPlayer(const Piece& piece) const
@@ -65,271 +546,534 @@ bool GameState::belongsToCurrentPlayer(const Piece& piece) const
 
 void GameState::changeTurnColor()
 {
-    m_turn_color = m_turn_color == PieceColor::White ? PieceColor::Black : PieceColor::White;
+    m_turn_color = oppositeColor(m_turn_color);
 }
 
 BoardCoordinate GameState::findKingPosition(PieceColor color) const
 {
-    for (short int i = 1; i <= 8; i++) {
-        for (short int j = 1; j <= 8; j++) {
-            BoardCoordinate cur(i, j);
-            std::optional<Piece> piece_at_cur = readBoard(cur);
-            if (piece_at_cur.has_value()
-                && piece_at_cur.value().getType() == PieceType::King
-                && piece_at_cur.value().getColor() == color) {
-                return cur;
-            }
+    CHESS_STATS_TIMER(FindKingPosition);
+    return BoardCoordinate(Square(m_king_squares[static_cast<int>(color)]));
+}
+
+Bitboard GameState::attackersTo(int square, PieceColor color, Bitboard occupied) const
+{
+    return (Attacks::pawn(oppositeColor(color), square) & m_board.pieces(color, PieceType::Pawn))
+        | (Attacks::knight(square) & m_board.pieces(color, PieceType::Knight))
+        | (Attacks::king(square) & m_board.pieces(color, PieceType::King))
+        | (Attacks::bishop(square, occupied) & (m_board.pieces(color, PieceType::Bishop) | m_board.pieces(color, PieceType::Queen)))
+        | (Attacks::rook(square, occupied) & (m_board.pieces(color, PieceType::Rook) | m_board.pieces(color, PieceType::Queen)));
+}
+
+void GameState::updateCheckInfo() const
+{
+    if (m_check_info_valid) {
+        return;
+    }
+    const PieceColor opposing_color = oppositeColor(m_turn_color);
+    const int king_square = m_king_squares[static_cast<int>(m_turn_color)];
+    const Bitboard theirs = m_board.pieces(opposing_color);
+    const Bitboard occupied = m_board.occupied();
+    m_checkers = attackersTo(king_square, opposing_color, occupied);
+
+    // A piece is pinned if it is the only one between the king and an opposing slider.
+    m_pinned = Bitboards::Empty;
+    const Bitboard opposing_queens = m_board.pieces(opposing_color, PieceType::Queen);
+    for (Bitboard snipers = (Attacks::rook(king_square, theirs) & (m_board.pieces(opposing_color, PieceType::Rook) | opposing_queens))
+             | (Attacks::bishop(king_square, theirs) & (m_board.pieces(opposing_color, PieceType::Bishop) | opposing_queens));
+         snipers != Bitboards::Empty;) {
+        const Bitboard blockers = Attacks::between(king_square, Bitboards::popLsb(snipers)) & occupied;
+        if (Bitboards::popCount(blockers) == 1) {
+            m_pinned |= blockers & m_board.pieces(m_turn_color);
         }
     }
-    throw std::runtime_error("No king of given color found");
+    m_check_info_valid = true;
 }
 
-bool GameState::isLegalMove(const BoardCoordinate source, const BoardCoordinate destiny) const
+Bitboard GameState::getCheckers() const
+{
+    updateCheckInfo();
+    return m_checkers;
+}
+
+bool GameState::isInCheck() const
+{
+    return getCheckers() != Bitboards::Empty;
+}
+
+bool GameState::canCastle(PieceColor color, int rook_column) const
 {
-    const Piece moving_piece = *this->readBoard(source);
-    // Check that moved piece belongs to current player.
-    if (!belongsToCurrentPlayer(moving_piece)) {
-        return false;
-    }
-
-    // Check that destiny square does not have a piece belonging to the current player
-    if (readBoard(destiny).has_value()
-        && belongsToCurrentPlayer(readBoard(destiny).value())) {
-        return false;
-    }
-
-    // Get delta X, delta Y, the position of the current player's king, and the opposing color.
-    const short int movedX = abs(source.getCol() - destiny.getCol());
-    const short int movedY = abs(source.getRow() - destiny.getRow());
-    const BoardCoordinate king_position = findKingPosition(m_turn_color);
-    const PieceColor opposing_color = m_turn_color == PieceColor::Black ? PieceColor::White : PieceColor::Black;
-
-    // Check that opposing knights will not keep making check after movement.
-    for (std::pair<short int, short int> knightPlaces : std::initializer_list<std::pair<short int, short int>> { { -2, -1 }, { -1, -2 }, { -1, 2 }, { 2, -1 }, { 1, 2 }, { 2, 1 }, { 1, -2 }, { -2, 1 } }) {
-        const std::optional<Piece> piece_at_offset = readBoard(king_position.getCol() + knightPlaces.first, king_position.getRow() + knightPlaces.second);
-        if (!(destiny.getCol() == king_position.getCol() + knightPlaces.first
-                && destiny.getRow() == king_position.getRow() + knightPlaces.second)
-            && piece_at_offset.has_value()
-            && piece_at_offset.value().getType() == PieceType::Knight
-            && piece_at_offset.value().getColor() == opposing_color) {
-            return false;
-        }
-    }
-
-    // Check that opposing rooks, bishops and queens will not keep making check after movement.
-    for (std::pair<short int, short int> modifiers : std::initializer_list<std::pair<short int, short int>> { { -1, -1 }, { 1, -1 }, { -1, 1 }, { 1, 1 }, { 0, 1 }, { 0, -1 }, { 1, 0 }, { -1, 0 } }) {
-        for (int x = king_position.getCol() + modifiers.first, y = king_position.getRow() + modifiers.second; x < 8 && x >= 0 && y < 8 && y >= 0; x += modifiers.first, y += modifiers.second) {
-            std::optional<Piece> piece_at_offset = readBoard(x, y);
-            if (piece_at_offset.has_value()) {
-                if (piece_at_offset.value().getColor() == opposing_color
-                    && !(destiny.getCol() == x && destiny.getRow() == y)
-                    && (readBoard(x, y)->getType() == PieceType::Queen
-                        || ((abs(modifiers.first) != abs(modifiers.second)
-                                && piece_at_offset.value().getType() == PieceType::Rook)
-                            || (abs(modifiers.first) == abs(modifiers.second)
-                                && piece_at_offset.value().getType() == PieceType::Bishop)))) {
-                    return false;
-                } else {
-                    break;
-                }
-            } else if (destiny.getCol() == x && destiny.getRow() == y) {
+    const int row = color == PieceColor::White ? 1 : 8;
+    const std::optional<Piece>& king = m_board.pieceAt(Bitboards::squareOf(BoardColumn::E, row));
+    const std::optional<Piece>& rook = m_board.pieceAt(Bitboards::squareOf(rook_column, row));
+    return king.has_value() && king->getType() == PieceType::King && king->getColor() == color && !king->hasMoved()
+        && rook.has_value() && rook->getType() == PieceType::Rook && rook->getColor() == color && !rook->hasMoved();
+}
+
+Bitboard GameState::castlingDestinations() const
+{
+    const int row = m_turn_color == PieceColor::White ? 1 : 8;
+    const PieceColor opposing_color = oppositeColor(m_turn_color);
+    const Bitboard occupied = m_board.occupied();
+    const bool is_white = m_turn_color == PieceColor::White;
+    Bitboard destinations = Bitboards::Empty;
+    if ((m_castling_rights & (is_white ? CastlingRights::WhiteKingSide : CastlingRights::BlackKingSide))
+        && !existInterrumptions(BoardCoordinate(Square::at(BoardColumn::E, row)), BoardCoordinate(Square::at(BoardColumn::H, row)))
+        && attackersTo(Bitboards::squareOf(BoardColumn::F, row), opposing_color, occupied) == Bitboards::Empty
+        && attackersTo(Bitboards::squareOf(BoardColumn::G, row), opposing_color, occupied) == Bitboards::Empty) {
+        destinations |= Bitboards::squareBit(Bitboards::squareOf(BoardColumn::G, row));
+    }
+    if ((m_castling_rights & (is_white ? CastlingRights::WhiteQueenSide : CastlingRights::BlackQueenSide))
+        && !existInterrumptions(BoardCoordinate(Square::at(BoardColumn::E, row)), BoardCoordinate(Square::at(BoardColumn::A, row)))
+        && attackersTo(Bitboards::squareOf(BoardColumn::D, row), opposing_color, occupied) == Bitboards::Empty
+        && attackersTo(Bitboards::squareOf(BoardColumn::C, row), opposing_color, occupied) == Bitboards::Empty) {
+        destinations |= Bitboards::squareBit(Bitboards::squareOf(BoardColumn::C, row));
+    }
+    return destinations;
+}
+
+void GameState::generateLegalMoves(MoveList& moves, MoveGeneration generation) const
+{
+    moves.clear();
+    const PieceColor opposing_color = oppositeColor(m_turn_color);
+    const Bitboard ours = m_board.pieces(m_turn_color);
+    const Bitboard theirs = m_board.pieces(opposing_color);
+    const Bitboard occupied = m_board.occupied();
+    const Bitboard generated_targets = generation == MoveGeneration::Captures ? theirs
+        : generation == MoveGeneration::Quiets                                ? ~occupied
+                                                                              : ~ours;
+    const int king_square = m_king_squares[static_cast<int>(m_turn_color)];
+    updateCheckInfo();
+    const Bitboard checkers = m_checkers;
+    const Bitboard pinned = m_pinned;
+
+    // The king may go to any square that is not attacked once it has left its current one.
+    const Bitboard occupied_without_king = occupied ^ Bitboards::squareBit(king_square);
+    for (Bitboard targets = Attacks::king(king_square) & generated_targets; targets != Bitboards::Empty;) {
+        const int to = Bitboards::popLsb(targets);
+        if (attackersTo(to, opposing_color, occupied_without_king) == Bitboards::Empty) {
+            moves.push(Move(king_square, to, (theirs & Bitboards::squareBit(to)) ? Move::Capture : Move::Quiet));
+        }
+    }
+    if (Bitboards::popCount(checkers) > 1) {
+        // Only the king can get out of a double check.
+        return;
+    }
+
+    // Other pieces must capture the checker or block it if the king is in check.
+    Bitboard evasions = ~Bitboards::Empty;
+    if (checkers != Bitboards::Empty) {
+        evasions = Attacks::between(king_square, Bitboards::lsb(checkers)) | checkers;
+    } else if (generation != MoveGeneration::Captures) {
+        for (Bitboard destinations = castlingDestinations(); destinations != Bitboards::Empty;) {
+            const int to = Bitboards::popLsb(destinations);
+            moves.push(Move(king_square, to, Bitboards::columnOf(to) == BoardColumn::G ? Move::KingCastle : Move::QueenCastle));
+        }
+    }
+
+    // Knights, bishops, rooks and queens.
+    for (PieceType type : { PieceType::Knight, PieceType::Bishop, PieceType::Rook, PieceType::Queen }) {
+        for (Bitboard pieces = m_board.pieces(m_turn_color, type); pieces != Bitboards::Empty;) {
+            const int from = Bitboards::popLsb(pieces);
+            Bitboard targets;
+            switch (type) {
+            case PieceType::Knight:
+                targets = Attacks::knight(from);
+                break;
+            case PieceType::Bishop:
+                targets = Attacks::bishop(from, occupied);
+                break;
+            case PieceType::Rook:
+                targets = Attacks::rook(from, occupied);
+                break;
+            default:
+                targets = Attacks::queen(from, occupied);
                 break;
             }
+            targets &= generated_targets & evasions;
+            if (pinned & Bitboards::squareBit(from)) {
+                targets &= Attacks::line(king_square, from);
+            }
+            while (targets != Bitboards::Empty) {
+                const int to = Bitboards::popLsb(targets);
+                moves.push(Move(from, to, (theirs & Bitboards::squareBit(to)) ? Move::Capture : Move::Quiet));
+            }
         }
     }
 
-    // Check that opposing pawns will not keep making check after movement.
-    for (int i : { -1, 1 }) {
-        if (readBoard(king_position.getCol() + i, king_position.getRow() + (opposing_color == PieceColor::White ? 1 : -1)).has_value()
-            && readBoard(king_position.getCol() + i, king_position.getRow() + (opposing_color == PieceColor::White ? 1 : -1))->getColor() == opposing_color
-            && readBoard(king_position.getCol() + i, king_position.getRow() + (opposing_color == PieceColor::White ? 1 : -1))->getType() == PieceType::Pawn) {
-            return false;
+    // Pawns.
+    const int forward = m_turn_color == PieceColor::White ? 8 : -8;
+    const int start_row = m_turn_color == PieceColor::White ? 2 : 7;
+    const Bitboard pawns = m_board.pieces(m_turn_color, PieceType::Pawn);
+    for (Bitboard remaining = pawns; remaining != Bitboards::Empty;) {
+        const int from = Bitboards::popLsb(remaining);
+        Bitboard allowed = evasions;
+        if (pinned & Bitboards::squareBit(from)) {
+            allowed &= Attacks::line(king_square, from);
+        }
+        const int single_push = from + forward;
+        const bool is_promotion = Bitboards::rowOf(single_push) == 1 || Bitboards::rowOf(single_push) == 8;
+        if (!m_board.isOccupied(single_push)) {
+            // Promotions are generated along with the captures.
+            if ((allowed & Bitboards::squareBit(single_push))
+                && (generation == MoveGeneration::All || (generation == MoveGeneration::Captures) == is_promotion)) {
+                pushPawnMove(moves, from, single_push, false);
+            }
+            const int double_push = single_push + forward;
+            if (generation != MoveGeneration::Captures && Bitboards::rowOf(from) == start_row
+                && !m_board.isOccupied(double_push) && (allowed & Bitboards::squareBit(double_push))) {
+                moves.push(Move(from, double_push, Move::DoublePawnPush));
+            }
+        }
+        if (generation != MoveGeneration::Quiets) {
+            for (Bitboard captures = Attacks::pawn(m_turn_color, from) & theirs & allowed; captures != Bitboards::Empty;) {
+                pushPawnMove(moves, from, Bitboards::popLsb(captures), true);
+            }
         }
     }
 
-    // Check that piece can reach destination.
-    switch (moving_piece.getType()) {
-    case PieceType::King:
-        if (existInterrumptions(source, destiny)) {
-            return false;
+    // En passant removes two pieces from the same row, so its legality is checked on the resulting occupancy.
+    if (generation != MoveGeneration::Quiets && pawn_double_moved_last_turn.has_value()) {
+        const int captured_square = Bitboards::squareOf(pawn_double_moved_last_turn->getCol(), pawn_double_moved_last_turn->getRow());
+        const int to = captured_square + forward;
+        for (Bitboard capturers = Attacks::pawn(opposing_color, to) & pawns; capturers != Bitboards::Empty;) {
+            const int from = Bitboards::popLsb(capturers);
+            const Bitboard occupied_after = (occupied ^ Bitboards::squareBit(from) ^ Bitboards::squareBit(captured_square)) | Bitboards::squareBit(to);
+            if ((attackersTo(king_square, opposing_color, occupied_after) & ~Bitboards::squareBit(captured_square)) == Bitboards::Empty) {
+                moves.push(Move(from, to, Move::EnPassant));
+            }
         }
-        if (destiny.getCol() == BoardColumn::G
-            && readBoard(BoardColumn::H, source.getRow()).has_value()
-            && !readBoard(BoardColumn::H, source.getRow())->hasMoved()
-            && movedY == 0
-            && !moving_piece.hasMoved()
-            && isLegalMove(source, BoardCoordinate(BoardColumn::F, moving_piece.getColor() == PieceColor::White ? 1 : 8))) {
-            return true;
+    }
+}
+
+bool GameState::isLegalMove(const BoardCoordinate source, const BoardCoordinate destiny) const
+{
+    CHESS_STATS_TIMER(IsLegalMove);
+    const int to = Bitboards::squareOf(destiny.getCol(), destiny.getRow());
+    return (legalDestinations(source) & Bitboards::squareBit(to)) != Bitboards::Empty;
+}
+
+Bitboard GameState::legalDestinations(const BoardCoordinate source) const
+{
+    const int from = Bitboards::squareOf(source.getCol(), source.getRow());
+    const std::optional<Piece>& piece = m_board.pieceAt(from);
+    if (!piece.has_value() || piece->getColor() != m_turn_color) {
+        return Bitboards::Empty;
+    }
+    updateCheckInfo();
+    const PieceColor opposing_color = oppositeColor(m_turn_color);
+    const Bitboard ours = m_board.pieces(m_turn_color);
+    const Bitboard theirs = m_board.pieces(opposing_color);
+    const Bitboard occupied = m_board.occupied();
+    const int king_square = m_king_squares[static_cast<int>(m_turn_color)];
+
+    if (piece->getType() == PieceType::King) {
+        Bitboard destinations = Bitboards::Empty;
+        const Bitboard occupied_without_king = occupied ^ Bitboards::squareBit(king_square);
+        for (Bitboard targets = Attacks::king(king_square) & ~ours; targets != Bitboards::Empty;) {
+            const int to = Bitboards::popLsb(targets);
+            if (attackersTo(to, opposing_color, occupied_without_king) == Bitboards::Empty) {
+                destinations |= Bitboards::squareBit(to);
+            }
         }
-        if (destiny.getCol() == BoardColumn::C
-            && readBoard(BoardColumn::A, source.getRow()).has_value()
-            && !readBoard(BoardColumn::A, source.getRow()).value().hasMoved()
-            && movedY == 0
-            && !moving_piece.hasMoved()
-            && isLegalMove(source, BoardCoordinate(BoardColumn::D, moving_piece.getColor() == PieceColor::White ? 1 : 8))) {
-            return true;
+        return m_checkers == Bitboards::Empty ? destinations | castlingDestinations() : destinations;
+    }
+    if (Bitboards::popCount(m_checkers) > 1) {
+        return Bitboards::Empty;
+    }
+
+    Bitboard allowed = ~ours;
+    if (m_checkers != Bitboards::Empty) {
+        allowed &= Attacks::between(king_square, Bitboards::lsb(m_checkers)) | m_checkers;
+    }
+    if (m_pinned & Bitboards::squareBit(from)) {
+        allowed &= Attacks::line(king_square, from);
+    }
+    switch (piece->getType()) {
+    case PieceType::Knight:
+        return Attacks::knight(from) & allowed;
+    case PieceType::Bishop:
+        return Attacks::bishop(from, occupied) & allowed;
+    case PieceType::Rook:
+        return Attacks::rook(from, occupied) & allowed;
+    case PieceType::Queen:
+        return Attacks::queen(from, occupied) & allowed;
+    default:
+        break;
+    }
+
+    // Pawns.
+    const int forward = m_turn_color == PieceColor::White ? 8 : -8;
+    Bitboard targets = Attacks::pawn(m_turn_color, from) & theirs;
+    if (!m_board.isOccupied(from + forward)) {
+        targets |= Bitboards::squareBit(from + forward);
+        const int start_row = m_turn_color == PieceColor::White ? 2 : 7;
+        if (Bitboards::rowOf(from) == start_row && !m_board.isOccupied(from + 2 * forward)) {
+            targets |= Bitboards::squareBit(from + 2 * forward);
         }
-        if (movedX > 1 || movedY > 1) {
-            return false;
+    }
+    Bitboard destinations = targets & allowed;
+    if (pawn_double_moved_last_turn.has_value()) {
+        const int captured_square = Bitboards::squareOf(pawn_double_moved_last_turn->getCol(), pawn_double_moved_last_turn->getRow());
+        const int to = captured_square + forward;
+        if (Attacks::pawn(m_turn_color, from) & Bitboards::squareBit(to)) {
+            const Bitboard occupied_after = (occupied ^ Bitboards::squareBit(from) ^ Bitboards::squareBit(captured_square)) | Bitboards::squareBit(to);
+            if ((attackersTo(king_square, opposing_color, occupied_after) & ~Bitboards::squareBit(captured_square)) == Bitboards::Empty) {
+                destinations |= Bitboards::squareBit(to);
+            }
         }
-        return true;
-    case PieceType::Queen:
-        if (existInterrumptions(source, destiny)) {
-            return false;
+    }
+    return destinations;
+}
+
+Move GameState::createMove(const BoardCoordinate source, const BoardCoordinate destiny, PieceType promotion) const
+{
+    const int from = source.toSquare().index();
+    const int to = destiny.toSquare().index();
+    const std::optional<Piece>& moving_piece = m_board.pieceAt(from);
+    const bool is_capture = m_board.isOccupied(to);
+    if (moving_piece.has_value() && moving_piece->getType() == PieceType::King
+        && abs(source.getCol() - destiny.getCol()) == 2) {
+        return Move(from, to, destiny.getCol() == BoardColumn::G ? Move::KingCastle : Move::QueenCastle);
+    }
+    if (moving_piece.has_value() && moving_piece->getType() == PieceType::Pawn) {
+        if (destiny.getRow() == 1 || destiny.getRow() == 8) {
+            return Move(from, to, promotionFlag(promotion, is_capture));
+        } else if (abs(source.getRow() - destiny.getRow()) == 2) {
+            return Move(from, to, Move::DoublePawnPush);
+        } else if (source.getCol() != destiny.getCol() && !is_capture) {
+            return Move(from, to, Move::EnPassant);
         }
-        return true;
-    case PieceType::Bishop:
-        if (movedX != movedY) {
-            return false;
+    }
+    return Move(from, to, is_capture ? Move::Capture : Move::Quiet);
+}
+
+std::optional<Move> GameState::findMove(std::string_view coordinate_notation) const
+{
+    MoveList moves;
+    generateLegalMoves(moves);
+    for (const Move move : moves) {
+        if (move.toCoordinateNotation() == coordinate_notation) {
+            return move;
         }
-        if (existInterrumptions(source, destiny)) {
-            return false;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::size_t> GameState::indexOfSanMove(std::string_view san, const MoveList& legal_moves) const
+{
+    while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?')) {
+        san.remove_suffix(1);
+    }
+    std::optional<std::size_t> found;
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+        const int flag = san.size() == 3 ? Move::KingCastle : Move::QueenCastle;
+        for (std::size_t i = 0; i < legal_moves.size(); i++) {
+            if (legal_moves[i].getFlag() == flag) {
+                return i;
+            }
         }
-        return true;
-    case PieceType::Knight:
-        if (!((movedX == 2 && movedY == 1) || (movedX == 1 && movedY == 2))) {
-            return false;
+        return std::nullopt;
+    }
+
+    PieceType type = PieceType::Pawn;
+    constexpr char san_piece_letters[] = { 'K', 'Q', 'B', 'N', 'R' };
+    const char* piece_letter = san.empty() ? std::end(san_piece_letters) : std::find(std::begin(san_piece_letters), std::end(san_piece_letters), san.front());
+    if (piece_letter != std::end(san_piece_letters)) {
+        type = static_cast<PieceType>(piece_letter - std::begin(san_piece_letters));
+        san.remove_prefix(1);
+    }
+    std::optional<PieceType> promotion;
+    if (type == PieceType::Pawn && !san.empty()) {
+        const char* promotion_letter = std::find(std::begin(san_piece_letters) + 1, std::end(san_piece_letters), san.back());
+        if (promotion_letter != std::end(san_piece_letters)) {
+            promotion = static_cast<PieceType>(promotion_letter - std::begin(san_piece_letters));
+            san.remove_suffix(san.size() >= 2 && san[san.size() - 2] == '=' ? 2 : 1);
         }
-        return true;
-    case PieceType::Rook:
-        if (movedX != 0 && movedY != 0) {
-            return false;
+    }
+    if (san.size() < 2 || san[san.size() - 2] < 'a' || san[san.size() - 2] > 'h' || san.back() < '1' || san.back() > '8') {
+        return std::nullopt;
+    }
+    const int to = Bitboards::squareOf(san[san.size() - 2] - 'a' + 1, san.back() - '0');
+    san.remove_suffix(2);
+    // What is left tells apart pieces of the same type that can reach the square.
+    int from_column = 0;
+    int from_row = 0;
+    for (const char c : san) {
+        if (c >= 'a' && c <= 'h') {
+            from_column = c - 'a' + 1;
+        } else if (c >= '1' && c <= '8') {
+            from_row = c - '0';
+        } else if (c != 'x') {
+            return std::nullopt;
         }
-        if (existInterrumptions(source, destiny)) {
-            return false;
+    }
+
+    for (std::size_t i = 0; i < legal_moves.size(); i++) {
+        const Move move = legal_moves[i];
+        if (move.getTo() != to || move.isCastling() || m_board.pieceAt(move.getFrom())->getType() != type
+            || move.isPromotion() != promotion.has_value() || (promotion.has_value() && move.getPromotion() != promotion)
+            || (from_column != 0 && Bitboards::columnOf(move.getFrom()) != from_column)
+            || (from_row != 0 && Bitboards::rowOf(move.getFrom()) != from_row)) {
+            continue;
         }
-        return true;
-    case PieceType::Pawn:
-        if ((moving_piece.getColor() == PieceColor::White
-                && source.getRow() > destiny.getRow())
-            || (moving_piece.getColor() == PieceColor::Black
-                && source.getRow() < destiny.getRow())) {
-            return false;
-        }
-        if (existInterrumptions(source, destiny)) {
-            return false;
-        }
-        if (((moving_piece.getColor() == PieceColor::White && source.getRow() == 2) || (moving_piece.getColor() == PieceColor::Black && source.getRow() == 7))
-            && movedX == 0 && movedY == 2 && !readBoard(destiny.getCol(), destiny.getRow()).has_value()) {
-            return true;
-        } else if (movedX == 1
-            && movedY == 1
-            && (readBoard(destiny.getCol(), destiny.getRow()).has_value()
-                || (source.getRow() == 5
-                    && moving_piece.getColor() == PieceColor::White
-                    && readBoard(destiny.getCol(), destiny.getRow() + 1).has_value()
-                    && readBoard(destiny.getCol(), destiny.getRow() + 1)->getType() == PieceType::Pawn
-                    && readBoard(destiny.getCol(), destiny.getRow() + 1) == this->pawn_double_moved_last_turn)
-                || (source.getRow() == 4
-                    && moving_piece.getColor() == PieceColor::Black
-                    && readBoard(destiny.getCol(), destiny.getRow() - 1).has_value()
-                    && readBoard(destiny.getCol(), destiny.getRow() - 1)->getType() == PieceType::Pawn
-                    && readBoard(destiny.getCol(), destiny.getRow() - 1) == this->pawn_double_moved_last_turn))) {
-            return true;
-        } else if (movedX != 0 || movedY != 1) {
-            return false;
+        if (found.has_value()) {
+            return std::nullopt;
         }
-        return true;
-    default:
-        return false;
+        found = i;
     }
+    return found;
 }
 
 void GameState::move(const BoardCoordinate source, const BoardCoordinate destiny)
 {
-    std::optional<Piece>& moving_piece = accessBoard(source.getCol(), source.getRow());
+    move(createMove(source, destiny));
+}
+
+void GameState::move(const Move move)
+{
+    CHESS_STATS_TIMER(Move);
+    applyMove(move);
+    m_undo_size = 0;
+}
+
+void GameState::makeMove(const Move move)
+{
+    if (m_undo_size == max_undo_depth) {
+        throw std::length_error("Too many moves pending to be unmade");
+    }
+    UndoRecord& record = m_undo_stack[m_undo_size++];
+    record.move = move;
+    record.moved_piece_had_moved = m_board.pieceAt(move.getFrom())->hasMoved();
+    if (move.isEnPassant()) {
+        record.captured_piece = m_board.pieceAt(move.getTo() - (m_turn_color == PieceColor::White ? 8 : -8));
+    } else {
+        record.captured_piece = m_board.pieceAt(move.getTo());
+    }
+    record.pawn_double_moved_last_turn = pawn_double_moved_last_turn;
+    record.castling_rights = m_castling_rights;
+    record.halfmove_clock = m_halfmove_clock;
+    record.hash = m_hash;
+    record.piece_square_score = m_piece_square_score;
+    record.phase = m_phase;
+    applyMove(move);
+}
+
+void GameState::unmakeMove()
+{
+    if (m_undo_size == 0) {
+        throw std::logic_error("No move pending to be unmade");
+    }
+    const UndoRecord& record = m_undo_stack[--m_undo_size];
+    const Move move = record.move;
+    const int from = move.getFrom();
+    const int to = move.getTo();
+    changeTurnColor();
+    if (m_turn_color == PieceColor::Black) {
+        m_fullmove_number--;
+    }
+
+    // Put the piece back, as a pawn if it was promoted.
+    Piece moved_piece(m_turn_color, move.isPromotion() ? PieceType::Pawn : m_board.pieceAt(to)->getType());
+    if (moved_piece.getType() == PieceType::King) {
+        m_king_squares[static_cast<int>(m_turn_color)] = from;
+    }
+    if (record.moved_piece_had_moved) {
+        moved_piece.setAsMoved();
+    }
+    m_board.removePiece(to);
+    m_board.putPiece(from, moved_piece);
+
+    if (move.isCastling()) {
+        // Castling is only possible with a rook that had not moved.
+        const int row = Bitboards::rowOf(from);
+        const int rook_from = Bitboards::squareOf(move.getFlag() == Move::KingCastle ? BoardColumn::H : BoardColumn::A, row);
+        const int rook_to = Bitboards::squareOf(move.getFlag() == Move::KingCastle ? BoardColumn::F : BoardColumn::D, row);
+        m_board.removePiece(rook_to);
+        m_board.putPiece(rook_from, Piece(m_turn_color, PieceType::Rook));
+    } else if (record.captured_piece.has_value()) {
+        const int captured_square = move.isEnPassant() ? to - (m_turn_color == PieceColor::White ? 8 : -8) : to;
+        m_board.putPiece(captured_square, record.captured_piece.value());
+    }
+
+    pawn_double_moved_last_turn = record.pawn_double_moved_last_turn;
+    m_castling_rights = record.castling_rights;
+    m_halfmove_clock = record.halfmove_clock;
+    m_hash = record.hash;
+    m_piece_square_score = record.piece_square_score;
+    m_phase = record.phase;
+    m_history.pop_back();
+    m_check_info_valid = false;
+    m_generation++;
+}
+
+void GameState::applyMove(const Move move)
+{
+    const int from = move.getFrom();
+    const int to = move.getTo();
+    Piece moving_piece = m_board.pieceAt(from).value();
+    const bool touches_castling_squares = (Bitboards::squareBit(from) | Bitboards::squareBit(to)) & castling_squares;
+    m_generation++;
 
-    // Move piece.
+    m_hash ^= enPassantKey();
+    m_hash ^= Zobrist::piece(moving_piece, from);
+    m_piece_square_score -= PieceSquare::value(moving_piece, from);
+    m_halfmove_clock = moving_piece.getType() == PieceType::Pawn || move.isCapture() ? 0 : m_halfmove_clock + 1;
     pawn_double_moved_last_turn.reset();
-    moving_piece->setAsMoved();
-    if (moving_piece->getType() == PieceType::Pawn
-        && source.getCol() != destiny.getCol()
-        && !readBoard(destiny.getCol(), destiny.getRow()).has_value()) {
-        // Check if move is en passant, and if it is remove the pawn.
-        if (moving_piece->getColor() == PieceColor::White
-            && readBoard(destiny.getCol(), destiny.getRow() + 1).has_value()) {
-            accessBoard(destiny.getCol(), destiny.getRow() + 1).reset();
-        } else if (moving_piece->getColor() == PieceColor::Black
-            && readBoard(destiny.getCol(), destiny.getRow() - 1).has_value()) {
-            accessBoard(destiny.getCol(), destiny.getRow() - 1).reset();
-        }
-    }
-    if (readBoard(destiny.getCol(), destiny.getRow()).has_value()) {
-        // Check if move is a capture, and if it is, remove the targetted piece.
-        accessBoard(destiny.getCol(), destiny.getRow()).reset();
-    }
-    if (moving_piece->getType() == PieceType::King
-        && source.getCol() == BoardColumn::E
-        && destiny.getCol() == BoardColumn::C) {
-        // Check if move is long castling, and if it is, move the rook.
-        accessBoard(BoardColumn::A, source.getRow())->setAsMoved();
-        std::swap(accessBoard(BoardColumn::A, source.getRow()),
-            accessBoard(BoardColumn::D, source.getRow()));
-    } else if (moving_piece->getType() == PieceType::King
-        && source.getCol() == BoardColumn::E
-        && destiny.getCol() == BoardColumn::G) {
-        // Check if move is short castling, and if it is, move the rook.
-        this->accessBoard(BoardColumn::H, source.getRow())->setAsMoved();
-        std::swap(accessBoard(BoardColumn::H, source.getRow()), accessBoard(BoardColumn::F, source.getRow()));
-    } else if (moving_piece->getType() == PieceType::Pawn
-        && destiny.getRow() == (moving_piece->getColor() == PieceColor::White ? 8 : 1)) {
-        // Check if move is promotion, and if it is, display promotion menu.
-        /*PieceType toPromote;
-        while (true) {
-            sf::Event event;
-            if (window.pollEvent(event)) {
-                switch (event.type) {
-                case sf::Event::Closed:
-                    window.close();
-                    exit(0);
-                default:
-                    break;
-                }
-            }
-            window.clear(moving_piece->getColor() == PieceColor::White ? sf::Color::White : sf::Color(100, 100, 100));
-            sf::Transformable transformer;
-            sf::RenderStates specificState;
-            transformer.setPosition(100, 350);
-            for (PieceType i : { PieceType::Queen, PieceType::Rook, PieceType::Bishop, PieceType::Knight }) {
-                transformer.move(100, 0);
-                specificState.transform = transformer.getTransform();
-                window.draw(this->pieces_sprites[static_cast<int>(moving_piece->getColor()) * 6 + static_cast<int>(i)), specificState);
-            }
-            window.display();
-            if (sf::Mouse::isButtonPressed(sf::Mouse::Left)) {
-                sf::Vector2f MousePosF = window.mapPixelToCoords(sf::Mouse::getPosition(window));
-                sf::Vector2i MousePos(MousePosF.x, MousePosF.y);
-                if (MousePos.y >= 350 && MousePos.y <= 450 && MousePos.x >= 200 && MousePos.x <= 600) {
-                    switch ((MousePos.x - 200) / 100) {
-                    case 0:
-                        toPromote = PieceType::Queen;
-                        break;
-                    case 1:
-                        toPromote = PieceType::Rook;
-                        break;
-                    case 2:
-                        toPromote = PieceType::Bishop;
-                        break;
-                    case 3:
-                        toPromote = PieceType::Knight;
-                        break;
-                    case 4:
-                        throw std::out_of_range("Out of promotable Pieces");
-                    }
-                    break;
-                }
-            }
-        }
-        moving_piece->promotePawnTo(toPromote);*/
-    } else if (moving_piece->getType() == PieceType::Pawn
-        && abs(source.getRow() - destiny.getRow()) == 2) {
-        // If pawn double moved, store moved pawn.
-        this->pawn_double_moved_last_turn = moving_piece;
+    if (move.isEnPassant()) {
+        // Remove the pawn that is captured en passant, which is behind the destiny square.
+        const int captured_square = to - (m_turn_color == PieceColor::White ? 8 : -8);
+        const Piece& captured_piece = m_board.pieceAt(captured_square).value();
+        m_hash ^= Zobrist::piece(captured_piece, captured_square);
+        m_piece_square_score -= PieceSquare::value(captured_piece, captured_square);
+        m_board.removePiece(captured_square);
+    } else if (move.isCapture()) {
+        const Piece& captured_piece = m_board.pieceAt(to).value();
+        m_hash ^= Zobrist::piece(captured_piece, to);
+        m_piece_square_score -= PieceSquare::value(captured_piece, to);
+        m_phase -= PieceSquare::phaseWeight(captured_piece.getType());
+        m_board.removePiece(to);
     }
+    if (move.isCastling()) {
+        // Move the rook to the other side of the king.
+        const int row = Bitboards::rowOf(from);
+        const int rook_from = Bitboards::squareOf(move.getFlag() == Move::KingCastle ? BoardColumn::H : BoardColumn::A, row);
+        const int rook_to = Bitboards::squareOf(move.getFlag() == Move::KingCastle ? BoardColumn::F : BoardColumn::D, row);
+        Piece rook = m_board.pieceAt(rook_from).value();
+        rook.setAsMoved();
+        m_board.removePiece(rook_from);
+        m_board.putPiece(rook_to, rook);
+        m_hash ^= Zobrist::piece(rook, rook_from) ^ Zobrist::piece(rook, rook_to);
+        m_piece_square_score += PieceSquare::value(rook, rook_to);
+        m_piece_square_score -= PieceSquare::value(rook, rook_from);
+    } else if (move.isPromotion()) {
+        moving_piece.promotePawnTo(move.getPromotion());
+        m_phase += PieceSquare::phaseWeight(move.getPromotion());
+    } else if (move.getFlag() == Move::DoublePawnPush) {
+        pawn_double_moved_last_turn = BoardCoordinate(Square(to));
+    }
+
     // Move piece
-    accessBoard(destiny.getCol(), destiny.getRow()) = moving_piece;
-    moving_piece.reset();
+    if (moving_piece.getType() == PieceType::King) {
+        m_king_squares[static_cast<int>(m_turn_color)] = to;
+    }
+    moving_piece.setAsMoved();
+    m_board.removePiece(from);
+    m_board.putPiece(to, moving_piece);
+    m_hash ^= Zobrist::piece(moving_piece, to);
+    m_piece_square_score += PieceSquare::value(moving_piece, to);
 
     // Change turn color
     changeTurnColor();
-}
\ No newline at end of file
+    m_check_info_valid = false;
+    if (m_turn_color == PieceColor::White) {
+        m_fullmove_number++;
+    }
+    m_hash ^= Zobrist::keys.black_to_move;
+    if (touches_castling_squares) {
+        m_hash ^= Zobrist::keys.castling[m_castling_rights];
+        m_castling_rights = computeCastlingRights();
+        m_hash ^= Zobrist::keys.castling[m_castling_rights];
+    }
+    m_hash ^= enPassantKey();
+    pushHistory();
+}
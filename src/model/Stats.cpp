@@ -0,0 +1,117 @@
+#include "../../include/model/Stats.hpp"
+#include <atomic>
+#include <fstream>
+#include <limits>
+
+namespace {
+    constexpr int counter_count = static_cast<int>(StatCounter::Count);
+    constexpr const char* counter_names[counter_count] = { "isLegalMove", "move", "findKingPosition",
+        "existInterrumptions", "draw", "frame" };
+
+    struct CounterState {
+        std::atomic<std::uint64_t> calls { 0 };
+        std::atomic<std::uint64_t> total_nanoseconds { 0 };
+        std::atomic<std::uint64_t> min_nanoseconds { std::numeric_limits<std::uint64_t>::max() };
+        std::atomic<std::uint64_t> max_nanoseconds { 0 };
+        /// Time taken since the last call to endFrame.
+        std::atomic<std::uint64_t> frame_nanoseconds { 0 };
+        std::array<std::atomic<std::uint64_t>, StatSummary::frame_histogram_buckets> frame_histogram {};
+    };
+
+    std::array<CounterState, counter_count> counters;
+
+    int histogramBucket(std::uint64_t nanoseconds)
+    {
+        int bucket = 0;
+        for (std::uint64_t microseconds = nanoseconds / 1000; microseconds != 0 && bucket < StatSummary::frame_histogram_buckets - 1; microseconds >>= 1) {
+            bucket++;
+        }
+        return bucket;
+    }
+}
+
+const char* Stats::nameOf(StatCounter counter)
+{
+    return counter_names[static_cast<int>(counter)];
+}
+
+void Stats::record(StatCounter counter, std::uint64_t nanoseconds)
+{
+    CounterState& state = counters[static_cast<int>(counter)];
+    state.calls.fetch_add(1, std::memory_order_relaxed);
+    state.total_nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    state.frame_nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    std::uint64_t min = state.min_nanoseconds.load(std::memory_order_relaxed);
+    while (nanoseconds < min && !state.min_nanoseconds.compare_exchange_weak(min, nanoseconds, std::memory_order_relaxed)) {
+    }
+    std::uint64_t max = state.max_nanoseconds.load(std::memory_order_relaxed);
+    while (nanoseconds > max && !state.max_nanoseconds.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+std::array<std::uint64_t, static_cast<int>(StatCounter::Count)> Stats::endFrame()
+{
+    std::array<std::uint64_t, counter_count> frame_times;
+    for (int counter = 0; counter < counter_count; counter++) {
+        CounterState& state = counters[counter];
+        frame_times[counter] = state.frame_nanoseconds.exchange(0, std::memory_order_relaxed);
+        state.frame_histogram[histogramBucket(frame_times[counter])].fetch_add(1, std::memory_order_relaxed);
+    }
+    return frame_times;
+}
+
+StatSummary Stats::summary(StatCounter counter)
+{
+    const CounterState& state = counters[static_cast<int>(counter)];
+    StatSummary summary;
+    summary.name = nameOf(counter);
+    summary.calls = state.calls.load(std::memory_order_relaxed);
+    summary.total_nanoseconds = state.total_nanoseconds.load(std::memory_order_relaxed);
+    summary.min_nanoseconds = summary.calls == 0 ? 0 : state.min_nanoseconds.load(std::memory_order_relaxed);
+    summary.max_nanoseconds = state.max_nanoseconds.load(std::memory_order_relaxed);
+    for (int bucket = 0; bucket < StatSummary::frame_histogram_buckets; bucket++) {
+        summary.frame_histogram[bucket] = state.frame_histogram[bucket].load(std::memory_order_relaxed);
+    }
+    return summary;
+}
+
+void Stats::reset()
+{
+    for (CounterState& state : counters) {
+        state.calls.store(0, std::memory_order_relaxed);
+        state.total_nanoseconds.store(0, std::memory_order_relaxed);
+        state.min_nanoseconds.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+        state.max_nanoseconds.store(0, std::memory_order_relaxed);
+        state.frame_nanoseconds.store(0, std::memory_order_relaxed);
+        for (std::atomic<std::uint64_t>& bucket : state.frame_histogram) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::string Stats::toJson()
+{
+    std::string json = "{\n  \"enabled\": ";
+    json += enabled ? "true" : "false";
+    json += ",\n  \"counters\": [";
+    for (int counter = 0; counter < counter_count; counter++) {
+        const StatSummary stats = summary(static_cast<StatCounter>(counter));
+        json += counter == 0 ? "\n" : ",\n";
+        json += "    { \"name\": \"" + std::string(stats.name) + "\", \"calls\": " + std::to_string(stats.calls)
+            + ", \"total_ns\": " + std::to_string(stats.total_nanoseconds) + ", \"min_ns\": " + std::to_string(stats.min_nanoseconds)
+            + ", \"max_ns\": " + std::to_string(stats.max_nanoseconds) + ", \"frame_histogram_us\": [";
+        for (int bucket = 0; bucket < StatSummary::frame_histogram_buckets; bucket++) {
+            json += (bucket == 0 ? "" : ", ") + std::to_string(stats.frame_histogram[bucket]);
+        }
+        json += "] }";
+    }
+    json += "\n  ]\n}\n";
+    return json;
+}
+
+bool Stats::writeJson(const std::string& path)
+{
+    std::ofstream file(path);
+    file << toJson();
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,385 @@
+/**
+ * @file bench.cpp
+ * @brief Declares bench.cpp, the entrypoint of chess_bench.
+ * @details Times the primitives of the model over a fixed corpus of positions, prints the results as JSON and compares
+ *          them with a baseline file, failing if any primitive got slower than the tolerance allows. Run it from the
+ *          root of the repository, where the corpus and the checked-in baseline live.
+ */
+#include "../../include/model/GameState.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The benchmarked primitives. Each one makes a pass over the corpus, adds what it read to a checksum so the
+ *        compiler cannot drop the work, and returns the number of operations it timed.
+ */
+class ModelBenchmarks {
+public:
+    /// Plies played from each position by the move benchmark before the position is loaded again.
+    static constexpr int line_plies = 8;
+
+private:
+    std::vector<GameState> m_states;
+    std::vector<Board> m_boards;
+    std::vector<CompactPosition> m_starts;
+    std::vector<std::vector<Move>> m_lines;
+    /// Column and row of every occupied square of the corpus, read from memory so that the checks cannot be folded.
+    std::vector<std::pair<int, int>> m_coordinates;
+
+public:
+    explicit ModelBenchmarks(const std::vector<std::string>& fens)
+    {
+        for (const std::string& fen : fens) {
+            m_states.push_back(GameState::fromFEN(fen));
+            m_boards.push_back(m_states.back().getBoard());
+            m_starts.push_back(m_states.back().toCompact());
+            // A line that depends only on the position, so it stays the same whatever order moves are generated in.
+            GameState state = m_states.back();
+            std::vector<Move> line;
+            MoveList moves;
+            for (int ply = 0; ply < line_plies; ply++) {
+                state.generateLegalMoves(moves);
+                if (moves.empty()) {
+                    break;
+                }
+                const Move move = *std::min_element(moves.begin(), moves.end(), [](Move a, Move b) { return a.getData() < b.getData(); });
+                line.push_back(move);
+                state.move(move);
+            }
+            m_lines.push_back(line);
+            for (Bitboard occupied = m_boards.back().occupied(); occupied != Bitboards::Empty;) {
+                const int square = Bitboards::popLsb(occupied);
+                m_coordinates.emplace_back(Bitboards::columnOf(square), Bitboards::rowOf(square));
+            }
+        }
+    }
+
+    std::size_t size() const
+    {
+        return m_states.size();
+    }
+
+    /**
+     * @brief Returns the plies played by a pass of the move benchmark.
+     */
+    std::size_t linePlies() const
+    {
+        std::size_t plies = 0;
+        for (const std::vector<Move>& line : m_lines) {
+            plies += line.size();
+        }
+        return plies;
+    }
+
+    std::uint64_t readBoard(std::uint64_t& checksum) const
+    {
+        for (const GameState& state : m_states) {
+            const Board& board = state.getBoard();
+            for (short int col = 1; col <= 8; col++) {
+                for (short int row = 1; row <= 8; row++) {
+                    const std::optional<Piece> piece = board.readBoard(col, row);
+                    checksum += piece.has_value() ? static_cast<int>(piece->getType()) + 1 : 0;
+                }
+            }
+        }
+        return m_states.size() * 64;
+    }
+
+    std::uint64_t accessBoard(std::uint64_t& checksum)
+    {
+        for (Board& board : m_boards) {
+            for (short int col = 1; col <= 8; col++) {
+                for (short int row = 1; row <= 8; row++) {
+                    checksum += board.accessBoard(col, row).has_value();
+                }
+            }
+        }
+        return m_boards.size() * 64;
+    }
+
+    std::uint64_t constructCoordinates(std::uint64_t& checksum) const
+    {
+        for (const auto& [col, row] : m_coordinates) {
+            const BoardCoordinate coordinate(col, row);
+            checksum += coordinate.getCol() * 8 + coordinate.getRow();
+        }
+        return m_coordinates.size();
+    }
+
+    std::uint64_t isLegalMove(std::uint64_t& checksum) const
+    {
+        std::uint64_t operations = 0;
+        for (const GameState& state : m_states) {
+            for (Bitboard sources = state.getBoard().pieces(state.getTurnColor()); sources != Bitboards::Empty;) {
+                const int from = Bitboards::popLsb(sources);
+                const BoardCoordinate source(Bitboards::columnOf(from), Bitboards::rowOf(from));
+                for (int col = 1; col <= 8; col++) {
+                    for (int row = 1; row <= 8; row++) {
+                        checksum += state.isLegalMove(source, BoardCoordinate(col, row));
+                        operations++;
+                    }
+                }
+            }
+        }
+        return operations;
+    }
+
+    /**
+     * @brief Loads every start position, like the move benchmark does between its lines.
+     */
+    std::uint64_t loadCompact(std::uint64_t& checksum)
+    {
+        GameState& state = m_states.front();
+        for (const CompactPosition& start : m_starts) {
+            state.loadCompact(start);
+            checksum += state.getHash();
+        }
+        state.loadCompact(m_starts.front());
+        return m_starts.size();
+    }
+
+    /**
+     * @brief Plays the line of every position, loading the position first. The loads are timed too, and main takes
+     *        them out using the time of loadCompact.
+     */
+    std::uint64_t move(std::uint64_t& checksum)
+    {
+        std::uint64_t operations = 0;
+        GameState& state = m_states.front();
+        for (std::size_t position = 0; position < m_starts.size(); position++) {
+            state.loadCompact(m_starts[position]);
+            for (const Move move : m_lines[position]) {
+                state.move(move);
+            }
+            checksum += state.getHash();
+            operations += m_lines[position].size();
+        }
+        // Leave the first position as it was for the other benchmarks.
+        state.loadCompact(m_starts.front());
+        return operations;
+    }
+
+    std::uint64_t findKingPosition(std::uint64_t& checksum) const
+    {
+        for (const GameState& state : m_states) {
+            checksum += state.findKingPosition(PieceColor::White).getCol() + state.findKingPosition(PieceColor::Black).getRow();
+        }
+        return m_states.size() * 2;
+    }
+
+    std::uint64_t existInterrumptions(std::uint64_t& checksum) const
+    {
+        std::uint64_t operations = 0;
+        for (const GameState& state : m_states) {
+            for (Bitboard sources = state.getBoard().occupied(); sources != Bitboards::Empty;) {
+                const int from = Bitboards::popLsb(sources);
+                const BoardCoordinate source(Bitboards::columnOf(from), Bitboards::rowOf(from));
+                for (int col = 1; col <= 8; col++) {
+                    for (int row = 1; row <= 8; row++) {
+                        checksum += state.existInterrumptions(source, BoardCoordinate(col, row));
+                        operations++;
+                    }
+                }
+            }
+        }
+        return operations;
+    }
+};
+
+namespace {
+    struct BenchmarkResult {
+        std::string name;
+        double nanoseconds_per_operation;
+        std::uint64_t operations;
+    };
+
+    /// Samples taken of every benchmark, of which the fastest is kept since noise only ever adds time.
+    constexpr int samples = 5;
+
+    void printUsage()
+    {
+        std::cout << "Usage: chess_bench [--corpus FILE] [--baseline FILE] [--tolerance PERCENT] [--min-time MS]\n"
+                  << "                   [--write-baseline FILE]\n"
+                  << "  --corpus FILE          Positions in FEN, one per line (default bench/corpus.fen).\n"
+                  << "  --baseline FILE        Results to compare with (default bench/baseline.json, skipped if missing).\n"
+                  << "  --tolerance PERCENT    Slowdown over the baseline reported as a regression (default 20).\n"
+                  << "  --min-time MS          Minimum duration of every sample (default 50).\n"
+                  << "  --write-baseline FILE  Also write the results to FILE, to become the new baseline.\n"
+                  << "  The results are printed as JSON. The exit status is nonzero if a benchmark regressed.\n";
+    }
+
+    std::vector<std::string> readCorpus(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file) {
+            throw std::runtime_error("Cannot open the corpus " + path);
+        }
+        std::vector<std::string> fens;
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line[0] != '#') {
+                fens.push_back(line);
+            }
+        }
+        return fens;
+    }
+
+    BenchmarkResult runBenchmark(const std::string& name, const std::function<std::uint64_t(std::uint64_t&)>& pass,
+        std::chrono::milliseconds min_time, std::uint64_t& checksum)
+    {
+        // Repeat the pass enough times for a sample to last at least min_time.
+        int repetitions = 1;
+        while (true) {
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < repetitions; i++) {
+                pass(checksum);
+            }
+            if (std::chrono::steady_clock::now() - start >= min_time) {
+                break;
+            }
+            repetitions *= 2;
+        }
+        BenchmarkResult result { name, 0, 0 };
+        for (int sample = 0; sample < samples; sample++) {
+            std::uint64_t operations = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < repetitions; i++) {
+                operations += pass(checksum);
+            }
+            const double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            const double per_operation = nanoseconds / operations;
+            if (sample == 0 || per_operation < result.nanoseconds_per_operation) {
+                result.nanoseconds_per_operation = per_operation;
+                result.operations = operations;
+            }
+        }
+        return result;
+    }
+
+    std::string toJson(const std::vector<BenchmarkResult>& results, std::size_t corpus_size)
+    {
+        std::ostringstream json;
+        json << std::fixed << std::setprecision(3) << "{\n  \"corpus_positions\": " << corpus_size << ",\n  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); i++) {
+            json << "    { \"name\": \"" << results[i].name << "\", \"ns_per_op\": " << results[i].nanoseconds_per_operation
+                 << ", \"operations\": " << results[i].operations << " }" << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        json << "  ]\n}\n";
+        return json.str();
+    }
+
+    /**
+     * @brief Reads the time per operation of every benchmark from results written by toJson.
+     */
+    std::map<std::string, double> readBaseline(std::istream& file)
+    {
+        std::map<std::string, double> baseline;
+        std::string line;
+        while (std::getline(file, line)) {
+            const std::size_t name = line.find("\"name\": \"");
+            const std::size_t time = line.find("\"ns_per_op\": ");
+            if (name == std::string::npos || time == std::string::npos) {
+                continue;
+            }
+            const std::size_t name_start = name + 9;
+            baseline[line.substr(name_start, line.find('"', name_start) - name_start)] = std::atof(line.c_str() + time + 13);
+        }
+        return baseline;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string corpus_path = "bench/corpus.fen";
+    std::string baseline_path = "bench/baseline.json";
+    std::string output_baseline_path;
+    double tolerance = 20;
+    int min_time = 50;
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--corpus" && i + 1 < argc) {
+            corpus_path = argv[++i];
+        } else if (argument == "--baseline" && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (argument == "--tolerance" && i + 1 < argc) {
+            tolerance = std::max(std::atof(argv[++i]), 0.0);
+        } else if (argument == "--min-time" && i + 1 < argc) {
+            min_time = std::max(std::atoi(argv[++i]), 1);
+        } else if (argument == "--write-baseline" && i + 1 < argc) {
+            output_baseline_path = argv[++i];
+        } else {
+            printUsage();
+            return argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    try {
+        ModelBenchmarks benchmarks(readCorpus(corpus_path));
+        const std::vector<std::pair<std::string, std::function<std::uint64_t(std::uint64_t&)>>> passes = {
+            { "board_read_board", [&](std::uint64_t& checksum) { return benchmarks.readBoard(checksum); } },
+            { "board_access_board", [&](std::uint64_t& checksum) { return benchmarks.accessBoard(checksum); } },
+            { "board_coordinate", [&](std::uint64_t& checksum) { return benchmarks.constructCoordinates(checksum); } },
+            { "is_legal_move", [&](std::uint64_t& checksum) { return benchmarks.isLegalMove(checksum); } },
+            { "load_compact", [&](std::uint64_t& checksum) { return benchmarks.loadCompact(checksum); } },
+            { "move", [&](std::uint64_t& checksum) { return benchmarks.move(checksum); } },
+            { "find_king_position", [&](std::uint64_t& checksum) { return benchmarks.findKingPosition(checksum); } },
+            { "exist_interrumptions", [&](std::uint64_t& checksum) { return benchmarks.existInterrumptions(checksum); } },
+        };
+        std::uint64_t checksum = 0;
+        std::vector<BenchmarkResult> results;
+        for (const auto& [name, pass] : passes) {
+            results.push_back(runBenchmark(name, pass, std::chrono::milliseconds(min_time), checksum));
+        }
+        // Every pass of move loads each position once, so the share of load_compact in each ply is taken out.
+        const auto result = [&](const std::string& name) {
+            return std::find_if(results.begin(), results.end(), [&](const BenchmarkResult& found) { return found.name == name; });
+        };
+        const double load_time = result("load_compact")->nanoseconds_per_operation;
+        result("move")->nanoseconds_per_operation -= load_time * benchmarks.size() / benchmarks.linePlies();
+        const std::string json = toJson(results, benchmarks.size());
+        std::cout << json;
+        // Printing the checksum keeps the work of every pass observable.
+        std::cerr << "checksum " << checksum << '\n';
+        if (!output_baseline_path.empty()) {
+            std::ofstream(output_baseline_path) << json;
+        }
+
+        std::ifstream baseline_file(baseline_path);
+        if (!baseline_file) {
+            std::cerr << "No baseline at " << baseline_path << ", nothing to compare with\n";
+            return EXIT_SUCCESS;
+        }
+        const std::map<std::string, double> baseline = readBaseline(baseline_file);
+        int regressions = 0;
+        std::cerr << std::fixed << std::setprecision(2);
+        for (const BenchmarkResult& result : results) {
+            const auto found = baseline.find(result.name);
+            std::cerr << std::left << std::setw(24) << result.name << std::right << std::setw(10) << result.nanoseconds_per_operation << " ns";
+            if (found == baseline.end() || found->second <= 0) {
+                std::cerr << "  (not in the baseline)\n";
+                continue;
+            }
+            const double change = 100 * (result.nanoseconds_per_operation / found->second - 1);
+            const bool regressed = change > tolerance;
+            regressions += regressed;
+            std::cerr << "  baseline " << std::setw(10) << found->second << " ns  " << std::showpos << change << std::noshowpos << '%'
+                      << (regressed ? "  REGRESSION" : "") << '\n';
+        }
+        return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
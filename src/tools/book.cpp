@@ -0,0 +1,132 @@
+/**
+ * @file book.cpp
+ * @brief Declares book.cpp, the entrypoint of chess_book.
+ * @details Builds an opening book from games read on the standard input, one game per line in coordinate notation.
+ *          Every move played in the first plies of the games becomes a book move, weighted by the number of games that
+ *          played it. The positions are keyed like Polyglot books, so other engines can use the book too.
+ */
+#include "../../include/engine/OpeningBook.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    struct KeyTest {
+        const char* moves;
+        std::uint64_t key;
+    };
+
+    /// Positions and keys given in the description of the Polyglot book format.
+    constexpr KeyTest key_tests[] = {
+        { "", 0x463B96181691FC9C },
+        { "e2e4", 0x823C9B50FD114196 },
+        { "e2e4 d7d5", 0x0756B94461C50FB0 },
+        { "e2e4 d7d5 e4e5", 0x662FAFB965DB29D4 },
+        { "e2e4 d7d5 e4e5 f7f5", 0x22A48B5A8E47FF78 },
+        { "e2e4 d7d5 e4e5 f7f5 e1e2", 0x652A607CA3F242C1 },
+        { "e2e4 d7d5 e4e5 f7f5 e1e2 e8f7", 0x00FDD303C946BDD9 },
+        { "a2a4 b7b5 h2h4 b5b4 c2c4", 0x3C8123EA7B067637 },
+        { "a2a4 b7b5 h2h4 b5b4 c2c4 b4c3 a1a3", 0x5C3F9B829B279560 },
+    };
+
+    /**
+     * @brief Checks OpeningBook::polyglotKey against the published keys and returns the number of mismatches.
+     */
+    int verifyKeys()
+    {
+        int errors = 0;
+        for (const KeyTest& test : key_tests) {
+            std::istringstream stream(test.moves);
+            std::string notation;
+            GameState state;
+            while (stream >> notation) {
+                state.move(state.findMove(notation).value());
+            }
+            const std::uint64_t key = OpeningBook::polyglotKey(state);
+            if (key != test.key) {
+                std::cout << "key of \"" << test.moves << "\" is " << std::hex << key << " instead of " << test.key << std::dec << std::endl;
+                errors++;
+            }
+        }
+        std::cout << std::size(key_tests) - errors << " of " << std::size(key_tests) << " keys match Polyglot" << std::endl;
+        return errors;
+    }
+
+    void printUsage()
+    {
+        std::cout << "Usage: chess_book [--plies N] [--min-games N] OUTPUT < games.txt\n"
+                  << "       chess_book --verify\n"
+                  << "  --plies N      Plies of every game added to the book (default 16).\n"
+                  << "  --min-games N  Moves played in fewer games are left out (default 1).\n"
+                  << "  --verify       Checks the position keys against the test positions of Polyglot.\n"
+                  << "  Every line of the input is a game, written as moves in coordinate notation like \"e2e4 e7e5\".\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int plies = 16;
+    std::uint32_t min_games = 1;
+    std::string output;
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--plies" && i + 1 < argc) {
+            plies = std::max(std::atoi(argv[++i]), 1);
+        } else if (argument == "--min-games" && i + 1 < argc) {
+            min_games = static_cast<std::uint32_t>(std::max(std::atoi(argv[++i]), 1));
+        } else if (argument == "--verify") {
+            return verifyKeys() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        } else if (argument.empty() || argument[0] == '-' || !output.empty()) {
+            printUsage();
+            return argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        } else {
+            output = argument;
+        }
+    }
+    if (output.empty()) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    // Number of games that played each move, by position key and encoded move.
+    std::map<std::pair<std::uint64_t, std::uint16_t>, std::uint32_t> counts;
+    std::string line;
+    std::size_t games = 0;
+    while (std::getline(std::cin, line)) {
+        std::istringstream stream(line);
+        std::string notation;
+        GameState state;
+        for (int ply = 0; ply < plies && stream >> notation; ply++) {
+            const std::optional<Move> move = state.findMove(notation);
+            if (!move.has_value()) {
+                std::cerr << "game " << games + 1 << ": illegal move " << notation << ", skipping the rest of the game" << std::endl;
+                break;
+            }
+            counts[{ OpeningBook::polyglotKey(state), OpeningBook::encodeMove(move.value()) }]++;
+            state.move(move.value());
+        }
+        games++;
+    }
+
+    std::vector<OpeningBook::Entry> entries;
+    for (const auto& [position, count] : counts) {
+        if (count >= min_games) {
+            entries.push_back({ position.first, position.second, static_cast<std::uint16_t>(std::min<std::uint32_t>(count, 0xFFFF)), 0 });
+        }
+    }
+    try {
+        OpeningBook::write(output, entries);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "wrote " << entries.size() << " entries from " << games << " games to " << output << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file host.cpp
+ * @brief Declares host.cpp, the entrypoint of chess_host.
+ * @details Hosts a large number of games in a GamePool and plays batches of moves on all of them, reporting the memory
+ *          per game and the number of moves validated per second.
+ */
+#include "../../include/host/GamePool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    /// Opening played in every game, one ply per batch.
+    const std::vector<const char*> opening = { "e2e4", "e7e5", "g1f3", "b8c6", "f1b5", "a7a6", "b5a4", "g8f6", "e1g1", "f8e7" };
+
+    /// An illegal move for white, sent to some games before the legal one to exercise the rejection path.
+    const char* const illegal_move = "a1a8";
+
+    int squareOf(const char* notation)
+    {
+        return Bitboards::squareOf(notation[0] - 'a' + 1, notation[1] - '0');
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void printUsage()
+    {
+        std::cout << "Usage: chess_host [--games N] [--threads N]\n"
+                  << "  --games N    Number of games hosted at once (default 1000000).\n"
+                  << "  --threads N  Worker threads applying the batches (default: the number of cores).\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t games = 1000000;
+    int threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--games" && i + 1 < argc) {
+            games = std::strtoull(argv[++i], nullptr, 10);
+        } else if (argument == "--threads" && i + 1 < argc) {
+            threads = std::max(std::atoi(argv[++i]), 1);
+        } else {
+            printUsage();
+            return argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    GamePool pool;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<GameId> ids;
+    ids.reserve(games);
+    for (std::size_t i = 0; i < games; i++) {
+        ids.push_back(pool.create());
+    }
+    const double create_seconds = secondsSince(start);
+    std::cout << "created " << pool.size() << " games in " << create_seconds << " s, " << pool.memoryUsage() / (1024.0 * 1024.0)
+              << " MiB, " << static_cast<double>(pool.memoryUsage()) / games << " bytes per game" << std::endl;
+
+    std::uint64_t accepted = 0;
+    std::uint64_t rejected = 0;
+    double apply_seconds = 0;
+    for (std::size_t ply = 0; ply < opening.size(); ply++) {
+        std::vector<MoveRequest> requests;
+        requests.reserve(games + games / 16 + 1);
+        for (std::size_t i = 0; i < games; i++) {
+            if (ply == 0 && i % 16 == 0) {
+                requests.push_back({ ids[i], static_cast<std::uint8_t>(squareOf(illegal_move)), static_cast<std::uint8_t>(squareOf(illegal_move + 2)) });
+            }
+            requests.push_back({ ids[i], static_cast<std::uint8_t>(squareOf(opening[ply])), static_cast<std::uint8_t>(squareOf(opening[ply] + 2)) });
+        }
+        start = std::chrono::steady_clock::now();
+        const std::vector<std::uint8_t> results = pool.applyMoves(requests, threads);
+        apply_seconds += secondsSince(start);
+        for (std::uint8_t result : results) {
+            (result ? accepted : rejected)++;
+        }
+    }
+    const std::uint64_t validated = accepted + rejected;
+    std::cout << "validated " << validated << " moves (" << accepted << " played, " << rejected << " rejected) in "
+              << apply_seconds << " s with " << threads << " threads, "
+              << static_cast<std::uint64_t>(apply_seconds > 0 ? validated / apply_seconds : 0) << " moves/s, "
+              << static_cast<std::uint64_t>(apply_seconds > 0 ? validated / apply_seconds / threads : 0)
+              << " moves/s per thread" << std::endl;
+
+    const GameState sample = pool.load(ids.back());
+    std::cout << "sample game: " << sample.toFEN() << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    for (GameId id : ids) {
+        pool.destroy(id);
+    }
+    std::cout << "destroyed " << games << " games in " << secondsSince(start) << " s" << std::endl;
+
+    const std::uint64_t expected_rejected = (games + 15) / 16;
+    if (accepted != games * opening.size() || rejected != expected_rejected) {
+        std::cerr << "expected " << games * opening.size() << " played and " << expected_rejected << " rejected moves" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
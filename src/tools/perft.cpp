@@ -0,0 +1,167 @@
+/**
+ * @file perft.cpp
+ * @brief Declares perft.cpp, the entrypoint of chess_perft.
+ * @details Counts the leaf nodes of the legal move tree of a position up to a depth, which is both a correctness check
+ *          of the move generator against published node counts and a throughput benchmark.
+ */
+#include "../../include/model/GameState.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    struct ReferencePosition {
+        const char* name;
+        const char* fen;
+        int default_depth;
+        std::vector<std::pair<int, std::uint64_t>> expected_nodes;
+    };
+
+    const char* const start_position = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    /// Positions and node counts from the Chess Programming Wiki perft results and well-known edge case collections.
+    const std::vector<ReferencePosition> reference_positions = {
+        { "start", start_position, 5,
+            { { 1, 20 }, { 2, 400 }, { 3, 8902 }, { 4, 197281 }, { 5, 4865609 }, { 6, 119060324 } } },
+        { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4,
+            { { 1, 48 }, { 2, 2039 }, { 3, 97862 }, { 4, 4085603 }, { 5, 193690690 } } },
+        { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5,
+            { { 1, 14 }, { 2, 191 }, { 3, 2812 }, { 4, 43238 }, { 5, 674624 }, { 6, 11030083 } } },
+        { "position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4,
+            { { 1, 6 }, { 2, 264 }, { 3, 9467 }, { 4, 422333 }, { 5, 15833292 } } },
+        { "position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4,
+            { { 1, 44 }, { 2, 1486 }, { 3, 62379 }, { 4, 2103487 }, { 5, 89941194 } } },
+        { "position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4,
+            { { 1, 46 }, { 2, 2079 }, { 3, 89890 }, { 4, 3894594 }, { 5, 164075551 } } },
+        { "illegal-ep-1", "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, { { 6, 1134888 } } },
+        { "illegal-ep-2", "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, { { 6, 1015133 } } },
+        { "ep-gives-check", "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, { { 6, 1440467 } } },
+        { "short-castle-check", "5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, { { 6, 661072 } } },
+        { "long-castle-check", "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, { { 6, 803711 } } },
+        { "castle-rights", "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, { { 4, 1274206 } } },
+        { "castle-prevented", "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, { { 4, 1720476 } } },
+        { "promote-out-of-check", "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, { { 6, 3821001 } } },
+        { "discovered-check", "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, { { 5, 1004658 } } },
+        { "promote-to-check", "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, { { 6, 217342 } } },
+        { "underpromote-to-check", "8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, { { 6, 92683 } } },
+        { "self-stalemate", "K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, { { 6, 2217 } } },
+        { "stalemate-checkmate-1", "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, { { 7, 567584 } } },
+        { "stalemate-checkmate-2", "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, { { 4, 23527 } } },
+    };
+
+    std::uint64_t perft(GameState& state, int depth)
+    {
+        MoveList moves;
+        state.generateLegalMoves(moves);
+        if (depth <= 1) {
+            return depth == 1 ? moves.size() : 1;
+        }
+        std::uint64_t nodes = 0;
+        for (const Move move : moves) {
+            state.makeMove(move);
+            nodes += perft(state, depth - 1);
+            state.unmakeMove();
+        }
+        return nodes;
+    }
+
+    /**
+     * @brief Runs perft and prints the node count, the elapsed time and the speed.
+     * @return The number of leaf nodes.
+     */
+    std::uint64_t timedPerft(const std::string& name, GameState& state, int depth, bool divide)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::uint64_t nodes = 0;
+        if (divide) {
+            MoveList moves;
+            state.generateLegalMoves(moves);
+            for (const Move move : moves) {
+                state.makeMove(move);
+                const std::uint64_t move_nodes = perft(state, depth - 1);
+                state.unmakeMove();
+                std::cout << "  " << move.toCoordinateNotation() << ": " << move_nodes << '\n';
+                nodes += move_nodes;
+            }
+        } else {
+            nodes = perft(state, depth);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << " depth " << depth << ": " << nodes << " nodes, " << seconds << " s, "
+                  << static_cast<std::uint64_t>(seconds > 0 ? nodes / seconds : 0) << " nodes/s" << std::endl;
+        return nodes;
+    }
+
+    void printUsage()
+    {
+        std::cout << "Usage: chess_perft [--depth N] [--fen FEN] [--divide]\n"
+                  << "  Without --fen, runs the reference suite and fails on any node count mismatch.\n"
+                  << "  --depth N  Checks every reference count up to depth N, or searches a FEN to depth N.\n"
+                  << "  --fen FEN  Runs perft on the given position instead of the reference suite.\n"
+                  << "  --divide   Prints the node count below each root move.\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int depth = 0;
+    std::string fen;
+    bool divide = false;
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--depth" && i + 1 < argc) {
+            depth = std::atoi(argv[++i]);
+        } else if (argument == "--fen" && i + 1 < argc) {
+            fen = argv[++i];
+        } else if (argument == "--divide") {
+            divide = true;
+        } else {
+            printUsage();
+            return argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    try {
+        if (!fen.empty()) {
+            GameState state = GameState::fromFEN(fen);
+            timedPerft("fen", state, depth > 0 ? depth : 1, divide);
+            return EXIT_SUCCESS;
+        }
+
+        int mismatches = 0;
+        std::uint64_t total_nodes = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (const ReferencePosition& position : reference_positions) {
+            GameState state = GameState::fromFEN(position.fen);
+            const int max_depth = depth > 0 ? depth : position.default_depth;
+            for (const std::pair<int, std::uint64_t>& expected : position.expected_nodes) {
+                if (expected.first > max_depth) {
+                    continue;
+                }
+                const std::uint64_t nodes = timedPerft(position.name, state, expected.first, divide);
+                total_nodes += nodes;
+                if (nodes != expected.second) {
+                    std::cerr << "MISMATCH: " << position.name << " depth " << expected.first << " expected "
+                              << expected.second << " nodes but got " << nodes << std::endl;
+                    mismatches++;
+                }
+            }
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "total: " << total_nodes << " nodes, " << seconds << " s, "
+                  << static_cast<std::uint64_t>(seconds > 0 ? total_nodes / seconds : 0) << " nodes/s" << std::endl;
+        if (mismatches > 0) {
+            std::cerr << mismatches << " node count mismatches" << std::endl;
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,407 @@
+/**
+ * @file pgn.cpp
+ * @brief Declares pgn.cpp, the entrypoint of chess_pgn.
+ * @details Validates the games of a PGN file, and optionally prints the final position of each game or converts them
+ *          into a game archive. The file is mapped into memory and cut into chunks at game boundaries, which a pool of
+ *          threads parses in parallel. Results are written in the order of the file.
+ */
+#include "../../include/archive/GameArchive.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    /// Nominal size of the chunks handed to the threads, which are then cut at the next game.
+    constexpr std::size_t chunk_size = std::size_t(1) << 22;
+    /// Chunks each thread may be ahead of the writer, which bounds the memory held by finished chunks.
+    constexpr std::size_t chunks_in_flight_per_thread = 4;
+
+    enum class Output {
+        Validation,
+        Fen,
+        Archive
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: chess_pgn [--threads N] [--fen | --archive OUTPUT] INPUT.pgn\n"
+                  << "  --threads N       Threads parsing games (default: the number of cores).\n"
+                  << "  --fen             Print the final position of every valid game in FEN.\n"
+                  << "  --archive OUTPUT  Append every valid game to the game archive OUTPUT.\n"
+                  << "  Invalid games are reported on the standard error, and make the exit status nonzero.\n";
+    }
+
+    bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    std::size_t lineEnd(std::string_view text, std::size_t position)
+    {
+        const std::size_t end = text.find('\n', position);
+        return end == std::string_view::npos ? text.size() : end;
+    }
+
+    /**
+     * @brief Returns the start of the first game at or after position, or the size of the text if there is none.
+     * @details A game starts with a tag line that does not follow another tag line, ignoring blank lines.
+     */
+    std::size_t nextGameStart(std::string_view text, std::size_t position)
+    {
+        if (position > 0 && position < text.size() && text[position - 1] != '\n') {
+            position = std::min(lineEnd(text, position) + 1, text.size());
+        }
+        // Find out what kind of line comes before, which may be in the previous chunk.
+        bool previous_is_tag = false;
+        std::size_t back = position;
+        while (back > 0 && isBlank(text[back - 1])) {
+            back--;
+        }
+        if (back > 0) {
+            const std::size_t previous_start = text.rfind('\n', back - 1);
+            previous_is_tag = text[previous_start == std::string_view::npos ? 0 : previous_start + 1] == '[';
+        }
+        while (position < text.size()) {
+            const std::size_t end = lineEnd(text, position);
+            std::size_t first = position;
+            while (first < end && isBlank(text[first])) {
+                first++;
+            }
+            if (first < end) {
+                const bool is_tag = text[first] == '[';
+                if (is_tag && !previous_is_tag) {
+                    return position;
+                }
+                previous_is_tag = is_tag;
+            }
+            position = end + 1;
+        }
+        return text.size();
+    }
+
+    GameResult parseResult(std::string_view token)
+    {
+        if (token == "1-0") {
+            return GameResult::WhiteWins;
+        } else if (token == "0-1") {
+            return GameResult::BlackWins;
+        } else if (token == "1/2-1/2") {
+            return GameResult::Draw;
+        }
+        return GameResult::Unknown;
+    }
+
+    bool isResult(std::string_view token)
+    {
+        return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+    }
+
+    /// What a thread produced for one chunk, waiting to be written in order.
+    struct ChunkResult {
+        bool done = false;
+        std::size_t games = 0;
+        std::size_t plies = 0;
+        /// Errors by index of the game in the chunk.
+        std::vector<std::pair<std::size_t, std::string>> errors;
+        std::string fens;
+        std::vector<unsigned char> archive_bytes;
+        std::vector<std::size_t> archive_sizes;
+    };
+
+    /**
+     * @brief Parses and replays games, keeping its buffers from one game to the next.
+     */
+    class GameParser {
+    private:
+        const Output m_output;
+        const CompactPosition m_initial_position;
+        GameState m_state;
+        MoveList m_legal_moves;
+        std::vector<std::uint8_t> m_move_indices;
+
+        /**
+         * @brief Reads the tag pairs at the start of a game, returning the FEN and Result values and the position
+         *        where the movetext starts.
+         */
+        static std::size_t readTags(std::string_view game, std::string_view& fen, std::string_view& result)
+        {
+            std::size_t position = 0;
+            while (position < game.size()) {
+                while (position < game.size() && isBlank(game[position])) {
+                    position++;
+                }
+                if (position == game.size() || game[position] != '[') {
+                    break;
+                }
+                const std::size_t end = lineEnd(game, position);
+                const std::string_view line = game.substr(position, end - position);
+                const std::size_t name_end = line.find(' ');
+                const std::size_t value_start = line.find('"');
+                const std::size_t value_end = line.rfind('"');
+                if (name_end != std::string_view::npos && value_start != std::string_view::npos && value_end > value_start) {
+                    const std::string_view name = line.substr(1, name_end - 1);
+                    const std::string_view value = line.substr(value_start + 1, value_end - value_start - 1);
+                    if (name == "FEN") {
+                        fen = value;
+                    } else if (name == "Result") {
+                        result = value;
+                    }
+                }
+                position = end;
+            }
+            return position;
+        }
+
+    public:
+        explicit GameParser(Output output)
+            : m_output(output)
+            , m_initial_position(GameState().toCompact())
+        {
+            m_move_indices.reserve(ArchiveFormat::max_plies);
+        }
+
+        /**
+         * @brief Replays a game and adds it to the result of its chunk, or returns why it is invalid.
+         */
+        std::optional<std::string> parse(std::string_view game, ChunkResult& chunk)
+        {
+            std::string_view fen;
+            std::string_view result_tag;
+            std::size_t position = readTags(game, fen, result_tag);
+            if (fen.empty()) {
+                m_state.loadCompact(m_initial_position);
+            } else {
+                try {
+                    m_state.loadFEN(fen);
+                } catch (const std::invalid_argument& error) {
+                    return std::string("invalid FEN: ") + error.what();
+                }
+            }
+            const CompactPosition start = m_state.toCompact();
+            m_move_indices.clear();
+            GameResult result = parseResult(result_tag);
+
+            while (position < game.size()) {
+                const char c = game[position];
+                if (isBlank(c)) {
+                    position++;
+                } else if (c == '{') {
+                    const std::size_t end = game.find('}', position);
+                    position = end == std::string_view::npos ? game.size() : end + 1;
+                } else if (c == ';' || c == '%') {
+                    position = lineEnd(game, position);
+                } else if (c == '(') {
+                    // Variations can nest, and are skipped whole.
+                    int depth = 0;
+                    for (; position < game.size(); position++) {
+                        if (game[position] == '(') {
+                            depth++;
+                        } else if (game[position] == ')' && --depth == 0) {
+                            position++;
+                            break;
+                        } else if (game[position] == '{') {
+                            position = std::min(game.find('}', position), game.size() - 1);
+                        }
+                    }
+                } else {
+                    std::size_t end = position;
+                    while (end < game.size() && !isBlank(game[end]) && game[end] != '{' && game[end] != '(' && game[end] != ';') {
+                        end++;
+                    }
+                    std::string_view token = game.substr(position, end - position);
+                    position = end;
+                    if (isResult(token)) {
+                        result = parseResult(token);
+                        break;
+                    }
+                    if (token[0] == '$') {
+                        continue;
+                    }
+                    // Drop move numbers, which may be glued to the move as in "12.Nf3" or "12...Nf6".
+                    const std::size_t digits = token.find_first_not_of("0123456789");
+                    if (digits != 0 && digits != std::string_view::npos && token[digits] == '.') {
+                        token.remove_prefix(std::min(token.find_first_not_of('.', digits), token.size()));
+                    } else if (digits == std::string_view::npos) {
+                        token = std::string_view();
+                    }
+                    if (token.empty()) {
+                        continue;
+                    }
+                    if (m_move_indices.size() == ArchiveFormat::max_plies) {
+                        return std::string("more than ") + std::to_string(ArchiveFormat::max_plies) + " plies";
+                    }
+                    ArchiveFormat::legalMoves(m_state, m_legal_moves);
+                    const std::optional<std::size_t> index = m_state.indexOfSanMove(token, m_legal_moves);
+                    if (!index.has_value()) {
+                        return "illegal or ambiguous move " + std::string(token) + " at ply " + std::to_string(m_move_indices.size() + 1);
+                    }
+                    m_move_indices.push_back(static_cast<std::uint8_t>(index.value()));
+                    m_state.move(m_legal_moves[index.value()]);
+                }
+            }
+
+            chunk.plies += m_move_indices.size();
+            if (m_output == Output::Fen) {
+                chunk.fens += m_state.toFEN();
+                chunk.fens += '\n';
+            } else if (m_output == Output::Archive) {
+                const std::size_t size_before = chunk.archive_bytes.size();
+                ArchiveFormat::encodeGame(start, m_move_indices, result, chunk.archive_bytes);
+                chunk.archive_sizes.push_back(chunk.archive_bytes.size() - size_before);
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * @brief Parses every game of a chunk of the text.
+         */
+        void parseChunk(std::string_view text, std::size_t begin, std::size_t end, ChunkResult& chunk)
+        {
+            for (std::size_t game_start = begin; game_start < end;) {
+                const std::size_t game_end = std::min(nextGameStart(text, game_start + 1), end);
+                const std::optional<std::string> error = parse(text.substr(game_start, game_end - game_start), chunk);
+                if (error.has_value()) {
+                    chunk.errors.emplace_back(chunk.games, error.value());
+                }
+                chunk.games++;
+                game_start = game_end;
+            }
+        }
+    };
+}
+
+int main(int argc, char** argv)
+{
+    int threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+    Output output = Output::Validation;
+    std::string archive_path;
+    std::string input_path;
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--threads" && i + 1 < argc) {
+            threads = std::max(std::atoi(argv[++i]), 1);
+        } else if (argument == "--fen") {
+            output = Output::Fen;
+        } else if (argument == "--archive" && i + 1 < argc) {
+            output = Output::Archive;
+            archive_path = argv[++i];
+        } else if (argument.empty() || argument[0] == '-' || !input_path.empty()) {
+            printUsage();
+            return argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        } else {
+            input_path = argument;
+        }
+    }
+    if (input_path.empty()) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    try {
+        const MappedFile file(input_path);
+        const std::string_view text(reinterpret_cast<const char*>(file.data()), file.size());
+        std::unique_ptr<GameArchiveWriter> archive;
+        if (output == Output::Archive) {
+            archive = std::make_unique<GameArchiveWriter>(archive_path);
+        }
+        const auto start_time = std::chrono::steady_clock::now();
+
+        // Chunk boundaries only need a short scan each, so they are found up front.
+        std::vector<std::size_t> boundaries = { nextGameStart(text, 0) };
+        for (std::size_t position = chunk_size; position < text.size(); position += chunk_size) {
+            const std::size_t boundary = nextGameStart(text, position);
+            if (boundary > boundaries.back()) {
+                boundaries.push_back(boundary);
+            }
+        }
+        if (boundaries.back() < text.size()) {
+            boundaries.push_back(text.size());
+        }
+        const std::size_t chunks = boundaries.size() - 1;
+
+        // Threads take the next chunk as soon as they finish one, so a slow chunk never holds up the others.
+        std::vector<ChunkResult> results(chunks);
+        std::atomic<std::size_t> next_chunk(0);
+        std::size_t written_chunks = 0;
+        std::mutex mutex;
+        std::condition_variable condition;
+        const std::size_t max_in_flight = chunks_in_flight_per_thread * threads;
+        std::vector<std::thread> workers;
+        for (int thread = 0; thread < threads; thread++) {
+            workers.emplace_back([&]() {
+                GameParser parser(output);
+                for (std::size_t chunk = next_chunk.fetch_add(1); chunk < chunks; chunk = next_chunk.fetch_add(1)) {
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        condition.wait(lock, [&]() { return chunk < written_chunks + max_in_flight; });
+                    }
+                    ChunkResult result;
+                    parser.parseChunk(text, boundaries[chunk], boundaries[chunk + 1], result);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    results[chunk] = std::move(result);
+                    results[chunk].done = true;
+                    condition.notify_all();
+                }
+            });
+        }
+
+        std::size_t games = 0;
+        std::size_t invalid_games = 0;
+        std::size_t plies = 0;
+        for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+            ChunkResult result;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&]() { return results[chunk].done; });
+                std::swap(result, results[chunk]);
+            }
+            for (const auto& [game, error] : result.errors) {
+                std::cerr << "game " << games + game + 1 << ": " << error << '\n';
+            }
+            std::cout << result.fens;
+            if (archive) {
+                const unsigned char* bytes = result.archive_bytes.data();
+                for (const std::size_t size : result.archive_sizes) {
+                    archive->appendEncoded(bytes, size);
+                    bytes += size;
+                }
+            }
+            games += result.games;
+            invalid_games += result.errors.size();
+            plies += result.plies;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                written_chunks++;
+            }
+            condition.notify_all();
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        if (archive) {
+            archive->flush();
+        }
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        std::cerr << games << " games, " << invalid_games << " invalid, " << plies << " plies in " << seconds << " s ("
+                  << static_cast<std::uint64_t>(games / std::max(seconds, 1e-9)) << " games/s, "
+                  << static_cast<std::uint64_t>(text.size() / std::max(seconds, 1e-9) / 1e6) << " MB/s)\n";
+        return invalid_games == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,135 @@
+/**
+ * @file smp_bench.cpp
+ * @brief Declares smp_bench.cpp, the entrypoint of chess_smp_bench.
+ * @details Searches a fixed set of positions to a fixed depth with 1, 2, 4... threads and reports the time to depth and
+ *          the speed of each thread count, so that regressions in the scaling of the parallel search show up.
+ */
+#include "../../include/engine/Engine.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct BenchmarkPosition {
+        const char* name;
+        /// Moves in coordinate notation played from the starting position.
+        const char* moves;
+    };
+
+    const std::vector<BenchmarkPosition> benchmark_positions = {
+        { "start", "" },
+        { "italian", "e2e4 e7e5 g1f3 b8c6 f1c4 f8c5 c2c3 g8f6 d2d4 e5d4" },
+        { "queens-gambit", "d2d4 d7d5 c2c4 e7e6 b1c3 g8f6 c1g5 f8e7 e2e3 e8g8" },
+        { "sicilian", "e2e4 c7c5 g1f3 d7d6 d2d4 c5d4 f3d4 g8f6 b1c3 a7a6" },
+        { "kings-indian", "d2d4 g8f6 c2c4 g7g6 b1c3 f8g7 e2e4 d7d6 g1f3 e8g8 f1e2 e7e5" },
+    };
+
+    GameState playMoves(const std::string& moves)
+    {
+        GameState state;
+        std::istringstream stream(moves);
+        std::string notation;
+        while (stream >> notation) {
+            const std::optional<Move> move = state.findMove(notation);
+            if (!move.has_value()) {
+                throw std::invalid_argument("Illegal move: " + notation);
+            }
+            state.move(move.value());
+        }
+        return state;
+    }
+
+    struct BenchmarkRun {
+        double seconds = 0;
+        std::uint64_t nodes = 0;
+    };
+
+    /**
+     * @brief Searches every benchmark position to the given depth from an empty table.
+     */
+    BenchmarkRun runBenchmark(Engine& engine, const std::vector<GameState>& positions, int depth)
+    {
+        BenchmarkRun run;
+        SearchLimits limits;
+        limits.depth = depth;
+        for (const GameState& position : positions) {
+            engine.clearHash();
+            const auto start = std::chrono::steady_clock::now();
+            const SearchResult result = engine.search(position, limits);
+            run.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            run.nodes += result.nodes;
+        }
+        return run;
+    }
+
+    void printUsage()
+    {
+        std::cout << "Usage: chess_smp_bench [--depth N] [--threads N] [--hash MB]\n"
+                  << "  --depth N    Depth every position is searched to (default 8).\n"
+                  << "  --threads N  Largest thread count measured (default: the number of cores).\n"
+                  << "  --hash MB    Size of the transposition table (default 64).\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int depth = 8;
+    int max_threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+    int hash_megabytes = 64;
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--depth" && i + 1 < argc) {
+            depth = std::atoi(argv[++i]);
+        } else if (argument == "--threads" && i + 1 < argc) {
+            max_threads = std::max(std::atoi(argv[++i]), 1);
+        } else if (argument == "--hash" && i + 1 < argc) {
+            hash_megabytes = std::max(std::atoi(argv[++i]), 1);
+        } else {
+            printUsage();
+            return argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    try {
+        std::vector<GameState> positions;
+        for (const BenchmarkPosition& position : benchmark_positions) {
+            positions.push_back(playMoves(position.moves));
+        }
+
+        Engine engine(hash_megabytes);
+        std::vector<int> thread_counts;
+        for (int threads = 1; threads < max_threads; threads *= 2) {
+            thread_counts.push_back(threads);
+        }
+        thread_counts.push_back(max_threads);
+
+        std::cout << positions.size() << " positions to depth " << depth << '\n'
+                  << std::setw(8) << "threads" << std::setw(12) << "time (s)" << std::setw(14) << "nodes"
+                  << std::setw(14) << "nodes/s" << std::setw(10) << "speedup" << '\n';
+        double single_thread_seconds = 0;
+        for (int threads : thread_counts) {
+            engine.setThreads(threads);
+            const BenchmarkRun run = runBenchmark(engine, positions, depth);
+            if (threads == 1) {
+                single_thread_seconds = run.seconds;
+            }
+            std::cout << std::setw(8) << threads << std::setw(12) << std::fixed << std::setprecision(3) << run.seconds
+                      << std::setw(14) << run.nodes << std::setw(14)
+                      << static_cast<std::uint64_t>(run.seconds > 0 ? run.nodes / run.seconds : 0) << std::setw(10)
+                      << std::setprecision(2) << (run.seconds > 0 ? single_thread_seconds / run.seconds : 0) << std::endl;
+        }
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
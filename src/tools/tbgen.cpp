@@ -0,0 +1,551 @@
+/**
+ * @file tbgen.cpp
+ * @brief Declares tbgen.cpp, the entrypoint of chess_tbgen.
+ * @details Generates distance-to-mate tablebases for endgames of up to four pieces by retrograde analysis, and writes
+ *          them in the format read by Tablebase. The legal moves of every position come from GameState, so the tables
+ *          agree with the rules of the game, and the optional verification pass replays every position of every table
+ *          through the move generator.
+ */
+#include "../../include/engine/Tablebase.hpp"
+#include "../../include/model/Attacks.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Squares = std::array<int, EndgameMaterial::max_pieces>;
+
+    const std::vector<std::string> default_endgames = { "KPK", "KRK", "KQK", "KBNK" };
+
+    /// Added to the number of unresolved moves of a position that can force a draw, so that it never reaches zero.
+    constexpr std::uint8_t can_draw = 128;
+
+    PieceColor oppositeColor(PieceColor color)
+    {
+        return color == PieceColor::White ? PieceColor::Black : PieceColor::White;
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * @brief Calls function(begin, end) on consecutive blocks of [0, count), which the threads take in turns.
+     */
+    template <typename Function>
+    void parallelFor(std::uint64_t count, int threads, const Function& function)
+    {
+        constexpr std::uint64_t block_size = 1 << 14;
+        std::atomic<std::uint64_t> next_block(0);
+        const auto work = [&]() {
+            for (std::uint64_t begin = next_block.fetch_add(block_size); begin < count; begin = next_block.fetch_add(block_size)) {
+                function(begin, std::min(begin + block_size, count));
+            }
+        };
+        std::vector<std::thread> workers;
+        for (int thread = 1; thread < threads; thread++) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief Returns true if the board has no more than a lone minor piece besides the kings, so nobody can mate.
+     */
+    bool isTrivialDraw(const Board& board)
+    {
+        const int pieces = Bitboards::popCount(board.occupied());
+        return pieces == 2 || (pieces == 3 && (board.pieces(PieceType::Bishop) | board.pieces(PieceType::Knight)) != Bitboards::Empty);
+    }
+
+    /**
+     * @brief Builds an endgame from the pieces of both sides, with the colors swapped into canonical order if needed.
+     */
+    EndgameMaterial canonicalMaterial(const std::string& white, const std::string& black)
+    {
+        const EndgameMaterial material = EndgameMaterial::fromName("K" + white + "K" + black);
+        return material.isCanonical() ? material : material.flipped();
+    }
+
+    /**
+     * @brief Retrograde analysis of one endgame.
+     * @details Every position first counts its legal moves that stay in the endgame, and resolves at once the moves
+     *          that capture or promote through the smaller tables. Then, for increasing distances, every position
+     *          resolved at that distance visits the positions that lead to it with one move. A loss makes them wins,
+     *          and a win takes one from their count of unresolved moves, making them losses once it reaches zero.
+     *          Positions never resolved are draws.
+     */
+    class Generator {
+    private:
+        const EndgameMaterial m_material;
+        const Tablebases& m_subtables;
+        const int m_threads;
+        const std::uint64_t m_positions;
+        /// Entries as written to the table, 0 until a position is resolved.
+        std::unique_ptr<std::atomic<std::uint16_t>[]> m_entries;
+        /// Moves of each position that stay in the endgame and are not resolved yet, plus can_draw.
+        std::unique_ptr<std::atomic<std::uint8_t>[]> m_counts;
+        /// Longest loss among the moves that leave the endgame, in plies, which bounds the loss of the position.
+        std::unique_ptr<std::uint16_t[]> m_loss_floors;
+        std::atomic<int> m_largest_entry;
+
+        void raiseLargestEntry(int entry)
+        {
+            int largest = m_largest_entry.load(std::memory_order_relaxed);
+            while (entry > largest && !m_largest_entry.compare_exchange_weak(largest, entry)) {
+            }
+        }
+
+        bool isSameKind(int piece, int other) const
+        {
+            return m_material.colorAt(piece) == m_material.colorAt(other) && m_material.typeAt(piece) == m_material.typeAt(other);
+        }
+
+        /**
+         * @brief Returns true if the squares are a possible position with the given player to move, with pieces of the
+         *        same kind in increasing order.
+         */
+        bool isValid(const Squares& squares, PieceColor turn_color) const
+        {
+            Bitboard occupied = Bitboards::Empty;
+            Bitboard pieces[2][6] = {};
+            for (int piece = 0; piece < m_material.size(); piece++) {
+                const Bitboard bit = Bitboards::squareBit(squares[piece]);
+                const PieceType type = m_material.typeAt(piece);
+                if ((occupied & bit) || (type == PieceType::Pawn && (Bitboards::rowOf(squares[piece]) == 1 || Bitboards::rowOf(squares[piece]) == 8))
+                    || (piece > 0 && isSameKind(piece, piece - 1) && squares[piece] < squares[piece - 1])) {
+                    return false;
+                }
+                occupied |= bit;
+                pieces[static_cast<int>(m_material.colorAt(piece))][static_cast<int>(type)] |= bit;
+            }
+            // The player who just moved cannot be in check.
+            const int king = squares[turn_color == PieceColor::White ? 1 : 0];
+            const Bitboard(&attackers)[6] = pieces[static_cast<int>(turn_color)];
+            const Bitboard queens = attackers[static_cast<int>(PieceType::Queen)];
+            return ((Attacks::pawn(oppositeColor(turn_color), king) & attackers[static_cast<int>(PieceType::Pawn)])
+                       | (Attacks::knight(king) & attackers[static_cast<int>(PieceType::Knight)])
+                       | (Attacks::king(king) & attackers[static_cast<int>(PieceType::King)])
+                       | (Attacks::bishop(king, occupied) & (attackers[static_cast<int>(PieceType::Bishop)] | queens))
+                       | (Attacks::rook(king, occupied) & (attackers[static_cast<int>(PieceType::Rook)] | queens)))
+                == Bitboards::Empty;
+        }
+
+        void load(GameState& state, const Squares& squares, PieceColor turn_color) const
+        {
+            CompactPosition position {};
+            for (int piece = 0; piece < m_material.size(); piece++) {
+                position.occupied |= Bitboards::squareBit(squares[piece]);
+            }
+            for (int piece = 0; piece < m_material.size(); piece++) {
+                const int code = static_cast<int>(m_material.colorAt(piece)) << 3 | static_cast<int>(m_material.typeAt(piece));
+                // Pieces are packed in the order of their squares.
+                const int slot = Bitboards::popCount(position.occupied & (Bitboards::squareBit(squares[piece]) - 1));
+                position.pieces[slot / 2] |= static_cast<std::uint8_t>(code << (4 * (slot % 2)));
+            }
+            position.fullmove_number = 1;
+            position.flags = turn_color == PieceColor::Black;
+            state.loadCompact(position);
+        }
+
+        /**
+         * @brief Returns the entry of the position reached by a capture or a promotion, from the smaller tables.
+         */
+        int probeConversion(const GameState& state) const
+        {
+            const std::optional<TablebaseResult> result = m_subtables.probe(state);
+            if (!result.has_value()) {
+                if (!isTrivialDraw(state.getBoard())) {
+                    throw std::logic_error("Missing tablebase for " + state.toFEN());
+                }
+                return 0;
+            }
+            return result->outcome == TablebaseOutcome::Draw ? 0 : result->plies_to_mate + 1;
+        }
+
+        /**
+         * @brief Calls function(index) with every position from which a move that stays in the endgame leads to the
+         *        given one.
+         */
+        template <typename Function>
+        void forEachPredecessor(const Squares& squares, PieceColor turn_color, const Function& function) const
+        {
+            const PieceColor mover = oppositeColor(turn_color);
+            Bitboard occupied = Bitboards::Empty;
+            for (int piece = 0; piece < m_material.size(); piece++) {
+                occupied |= Bitboards::squareBit(squares[piece]);
+            }
+            for (int piece = 0; piece < m_material.size(); piece++) {
+                if (m_material.colorAt(piece) != mover) {
+                    continue;
+                }
+                const int to = squares[piece];
+                Bitboard origins = Bitboards::Empty;
+                switch (m_material.typeAt(piece)) {
+                case PieceType::King:
+                    origins = Attacks::king(to);
+                    break;
+                case PieceType::Queen:
+                    origins = Attacks::queen(to, occupied);
+                    break;
+                case PieceType::Bishop:
+                    origins = Attacks::bishop(to, occupied);
+                    break;
+                case PieceType::Knight:
+                    origins = Attacks::knight(to);
+                    break;
+                case PieceType::Rook:
+                    origins = Attacks::rook(to, occupied);
+                    break;
+                case PieceType::Pawn: {
+                    // Pawns step back towards their starting row, two squares at once from the row of double pushes.
+                    const int backward = mover == PieceColor::White ? -8 : 8;
+                    const int row = Bitboards::rowOf(to);
+                    if (row != (mover == PieceColor::White ? 2 : 7)) {
+                        origins |= Bitboards::squareBit(to + backward);
+                        if (row == (mover == PieceColor::White ? 4 : 5) && !(occupied & Bitboards::squareBit(to + backward))) {
+                            origins |= Bitboards::squareBit(to + 2 * backward);
+                        }
+                    }
+                    break;
+                }
+                }
+                for (origins &= ~occupied; origins != Bitboards::Empty;) {
+                    Squares previous = squares;
+                    int moved = piece;
+                    previous[moved] = Bitboards::popLsb(origins);
+                    for (; moved > 0 && isSameKind(moved, moved - 1) && previous[moved] < previous[moved - 1]; moved--) {
+                        std::swap(previous[moved], previous[moved - 1]);
+                    }
+                    for (; moved + 1 < m_material.size() && isSameKind(moved, moved + 1) && previous[moved] > previous[moved + 1]; moved++) {
+                        std::swap(previous[moved], previous[moved + 1]);
+                    }
+                    if (isValid(previous, mover)) {
+                        function(m_material.indexOf(previous, mover));
+                    }
+                }
+            }
+        }
+
+        void initialize(std::uint64_t begin, std::uint64_t end)
+        {
+            GameState state;
+            MoveList moves;
+            Squares squares;
+            PieceColor turn_color;
+            for (std::uint64_t index = begin; index < end; index++) {
+                m_entries[index].store(0, std::memory_order_relaxed);
+                m_counts[index].store(0, std::memory_order_relaxed);
+                m_loss_floors[index] = 0;
+                m_material.decode(index, squares, turn_color);
+                if (!isValid(squares, turn_color)) {
+                    continue;
+                }
+                load(state, squares, turn_color);
+                state.generateLegalMoves(moves);
+                if (moves.empty()) {
+                    // Mates are lost in 0 plies and stalemates are draws.
+                    m_entries[index].store(state.isInCheck() ? 1 : 0, std::memory_order_relaxed);
+                    m_counts[index].store(can_draw, std::memory_order_relaxed);
+                    raiseLargestEntry(state.isInCheck() ? 1 : 0);
+                    continue;
+                }
+
+                int unresolved = 0;
+                bool draws = false;
+                int shortest_win = 0;
+                int longest_loss = 0;
+                for (const Move move : moves) {
+                    if (!move.isCapture() && !move.isPromotion()) {
+                        unresolved++;
+                        continue;
+                    }
+                    state.makeMove(move);
+                    const int entry = probeConversion(state);
+                    state.unmakeMove();
+                    if (entry == 0) {
+                        draws = true;
+                    } else if ((entry - 1) % 2 == 0) {
+                        // The opponent is lost in entry - 1 plies, so this move wins in entry plies.
+                        shortest_win = shortest_win == 0 ? entry : std::min(shortest_win, entry);
+                    } else {
+                        longest_loss = std::max(longest_loss, entry);
+                    }
+                }
+                m_counts[index].store(static_cast<std::uint8_t>(unresolved + (draws ? can_draw : 0)), std::memory_order_relaxed);
+                m_loss_floors[index] = static_cast<std::uint16_t>(longest_loss);
+                if (shortest_win != 0) {
+                    m_entries[index].store(static_cast<std::uint16_t>(shortest_win + 1), std::memory_order_relaxed);
+                    raiseLargestEntry(shortest_win + 1);
+                } else if (unresolved == 0 && !draws) {
+                    m_entries[index].store(static_cast<std::uint16_t>(longest_loss + 1), std::memory_order_relaxed);
+                    raiseLargestEntry(longest_loss + 1);
+                }
+            }
+        }
+
+        void propagate(std::uint64_t begin, std::uint64_t end, int plies)
+        {
+            Squares squares;
+            PieceColor turn_color;
+            for (std::uint64_t index = begin; index < end; index++) {
+                if (m_entries[index].load(std::memory_order_relaxed) != plies + 1) {
+                    continue;
+                }
+                m_material.decode(index, squares, turn_color);
+                if (plies % 2 == 0) {
+                    // A loss: whoever can move into it wins in one more ply, unless they already win faster.
+                    const std::uint16_t win = static_cast<std::uint16_t>(plies + 2);
+                    forEachPredecessor(squares, turn_color, [&](std::uint64_t previous) {
+                        std::uint16_t entry = m_entries[previous].load(std::memory_order_relaxed);
+                        while ((entry == 0 || (entry % 2 == 0 && entry > win))
+                            && !m_entries[previous].compare_exchange_weak(entry, win, std::memory_order_relaxed)) {
+                        }
+                    });
+                    raiseLargestEntry(plies + 2);
+                } else {
+                    // A win: whoever moves into it has one good move less, and loses once they have none.
+                    forEachPredecessor(squares, turn_color, [&](std::uint64_t previous) {
+                        if (m_counts[previous].fetch_sub(1, std::memory_order_relaxed) == 1) {
+                            const int loss = std::max<int>(plies + 1, m_loss_floors[previous]);
+                            std::uint16_t unresolved = 0;
+                            if (m_entries[previous].compare_exchange_strong(unresolved, static_cast<std::uint16_t>(loss + 1), std::memory_order_relaxed)) {
+                                raiseLargestEntry(loss + 1);
+                            }
+                        }
+                    });
+                }
+            }
+        }
+
+        /**
+         * @brief Checks a range of positions against their successors, and returns the number of inconsistent ones.
+         */
+        std::uint64_t verify(std::uint64_t begin, std::uint64_t end) const
+        {
+            GameState state;
+            MoveList moves;
+            Squares squares;
+            PieceColor turn_color;
+            std::uint64_t errors = 0;
+            for (std::uint64_t index = begin; index < end; index++) {
+                m_material.decode(index, squares, turn_color);
+                if (!isValid(squares, turn_color)) {
+                    continue;
+                }
+                load(state, squares, turn_color);
+                state.generateLegalMoves(moves);
+                int expected = moves.empty() && state.isInCheck() ? 1 : 0;
+                int shortest_win = 0;
+                int longest_loss = 0;
+                bool draws = false;
+                for (const Move move : moves) {
+                    state.makeMove(move);
+                    const int entry = move.isCapture() || move.isPromotion()
+                        ? probeConversion(state)
+                        : m_entries[m_material.indexOf(state.getBoard(), state.getTurnColor(), false)].load(std::memory_order_relaxed);
+                    state.unmakeMove();
+                    if (entry == 0) {
+                        draws = true;
+                    } else if ((entry - 1) % 2 == 0) {
+                        shortest_win = shortest_win == 0 ? entry + 1 : std::min(shortest_win, entry + 1);
+                    } else {
+                        longest_loss = std::max(longest_loss, entry + 1);
+                    }
+                }
+                if (shortest_win != 0) {
+                    expected = shortest_win;
+                } else if (!moves.empty() && !draws) {
+                    expected = longest_loss;
+                }
+                errors += m_entries[index].load(std::memory_order_relaxed) != expected;
+            }
+            return errors;
+        }
+
+    public:
+        Generator(const EndgameMaterial& material, const Tablebases& subtables, int threads)
+            : m_material(material)
+            , m_subtables(subtables)
+            , m_threads(threads)
+            , m_positions(material.positions())
+            , m_entries(new std::atomic<std::uint16_t>[material.positions()])
+            , m_counts(new std::atomic<std::uint8_t>[material.positions()])
+            , m_loss_floors(new std::uint16_t[material.positions()])
+            , m_largest_entry(0)
+        {
+        }
+
+        void generate()
+        {
+            parallelFor(m_positions, m_threads, [&](std::uint64_t begin, std::uint64_t end) { initialize(begin, end); });
+            for (int plies = 0; plies + 1 <= m_largest_entry.load(); plies++) {
+                parallelFor(m_positions, m_threads, [&](std::uint64_t begin, std::uint64_t end) { propagate(begin, end, plies); });
+            }
+        }
+
+        std::uint64_t verify() const
+        {
+            std::atomic<std::uint64_t> errors(0);
+            parallelFor(m_positions, m_threads, [&](std::uint64_t begin, std::uint64_t end) { errors += verify(begin, end); });
+            return errors.load();
+        }
+
+        /**
+         * @brief Prints how many positions are won, lost and drawn, and a position with the longest mate.
+         */
+        void printSummary() const
+        {
+            std::uint64_t counts[3] = { 0, 0, 0 };
+            std::uint64_t longest = 0;
+            Squares squares;
+            PieceColor turn_color;
+            for (std::uint64_t index = 0; index < m_positions; index++) {
+                m_material.decode(index, squares, turn_color);
+                if (!isValid(squares, turn_color)) {
+                    continue;
+                }
+                const int entry = m_entries[index].load(std::memory_order_relaxed);
+                counts[static_cast<int>(Tablebase::resultOf(entry).outcome) + 1]++;
+                if (entry > m_entries[longest].load(std::memory_order_relaxed)) {
+                    longest = index;
+                }
+            }
+            std::cout << "  " << counts[2] << " won, " << counts[0] << " lost, " << counts[1] << " drawn positions";
+            if (m_entries[longest].load() != 0) {
+                GameState state;
+                m_material.decode(longest, squares, turn_color);
+                load(state, squares, turn_color);
+                std::cout << ", longest mate " << m_entries[longest].load() - 1 << " plies in " << state.toFEN();
+            }
+            std::cout << std::endl;
+        }
+
+        void write(const std::string& path) const
+        {
+            std::vector<std::uint16_t> entries(m_positions);
+            for (std::uint64_t index = 0; index < m_positions; index++) {
+                entries[index] = m_entries[index].load(std::memory_order_relaxed);
+            }
+            Tablebase::write(path, m_material, entries);
+        }
+    };
+
+    struct Options {
+        int threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+        std::string output = ".";
+        bool verify = false;
+    };
+
+    /**
+     * @brief Generates an endgame after the smaller endgames its captures and promotions lead to.
+     */
+    void generateWithDependencies(const EndgameMaterial& material, const Options& options, Tablebases& tables,
+        std::set<std::string>& generated)
+    {
+        if (material.isTrivialDraw() || generated.count(material.getName()) != 0) {
+            return;
+        }
+        const std::string name = material.getName();
+        const std::size_t second_king = name.find('K', 1);
+        // Pieces of white and black besides the kings.
+        const std::string sides[2] = { name.substr(1, second_king - 1), name.substr(second_king + 1) };
+        if (std::count(name.begin(), name.end(), 'P') > 1) {
+            // With two pawns, en passant captures make positions that the index cannot tell apart.
+            throw std::invalid_argument(name + ": endgames with more than one pawn are not supported");
+        }
+
+        for (int side = 0; side < 2; side++) {
+            for (std::size_t piece = 0; piece < sides[side].size(); piece++) {
+                std::string captured[2] = { sides[0], sides[1] };
+                captured[side].erase(piece, 1);
+                generateWithDependencies(canonicalMaterial(captured[0], captured[1]), options, tables, generated);
+                if (sides[side][piece] == 'P') {
+                    for (char promotion : { 'Q', 'R', 'B', 'N' }) {
+                        std::string promoted[2] = { sides[0], sides[1] };
+                        promoted[side][piece] = promotion;
+                        generateWithDependencies(canonicalMaterial(promoted[0], promoted[1]), options, tables, generated);
+                    }
+                }
+            }
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        Generator generator(material, tables, options.threads);
+        generator.generate();
+        const std::string path = options.output + "/" + name + Tablebases::extension;
+        generator.write(path);
+        std::cout << name << ": " << material.positions() << " indices in " << secondsSince(start) << " s, written to " << path << std::endl;
+        generator.printSummary();
+        if (options.verify) {
+            const auto verify_start = std::chrono::steady_clock::now();
+            const std::uint64_t errors = generator.verify();
+            std::cout << "  verified in " << secondsSince(verify_start) << " s: " << errors << " inconsistent positions" << std::endl;
+            if (errors != 0) {
+                throw std::logic_error(name + " does not agree with the move generator");
+            }
+        }
+        tables.add(path);
+        generated.insert(name);
+    }
+
+    void printUsage()
+    {
+        std::cout << "Usage: chess_tbgen [--threads N] [--output DIR] [--verify] [ENDGAME...]\n"
+                  << "  ENDGAME       Endgames to generate, like KQKR, of up to four pieces and one pawn\n"
+                  << "                (default: KPK KRK KQK KBNK). The smaller endgames they need are generated too.\n"
+                  << "  --threads N   Worker threads (default: the number of cores).\n"
+                  << "  --output DIR  Directory the tables are written to (default: the current directory).\n"
+                  << "  --verify      Checks every position against its successors with the move generator.\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    std::vector<std::string> names;
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--threads" && i + 1 < argc) {
+            options.threads = std::max(std::atoi(argv[++i]), 1);
+        } else if (argument == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (argument == "--verify") {
+            options.verify = true;
+        } else if (!argument.empty() && argument[0] != '-') {
+            names.push_back(argument);
+        } else {
+            printUsage();
+            return argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (names.empty()) {
+        names = default_endgames;
+    }
+
+    try {
+        Tablebases tables;
+        std::set<std::string> generated;
+        for (const std::string& name : names) {
+            const EndgameMaterial material = EndgameMaterial::fromName(name);
+            generateWithDependencies(material.isCanonical() ? material : material.flipped(), options, tables, generated);
+        }
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,275 @@
+/**
+ * @file uci.cpp
+ * @brief Declares uci.cpp, the entrypoint of chess_uci.
+ * @details Speaks the Universal Chess Interface protocol on the standard input and output, so that chess GUIs and
+ *          tournament managers can play with the engine. Searches run on a worker thread, so commands like stop and
+ *          isready are answered while the engine thinks.
+ */
+#include "../../include/engine/Engine.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+    const char* const start_position = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    /// Milliseconds kept aside per move for the communication with the GUI.
+    constexpr int move_overhead = 30;
+
+    /// Moves to the next time control assumed when the GUI does not say.
+    constexpr int default_moves_to_go = 30;
+
+    std::string scoreToUci(int score)
+    {
+        if (score >= Score::MateBound) {
+            return "mate " + std::to_string((Score::Mate - score + 1) / 2);
+        } else if (score <= -Score::MateBound) {
+            return "mate " + std::to_string(-(Score::Mate + score) / 2);
+        }
+        return "cp " + std::to_string(score);
+    }
+
+    class UciSession {
+    private:
+        Engine m_engine;
+        GameState m_state;
+        std::thread m_search_thread;
+        std::mutex m_output_mutex;
+
+        /// Guards m_waiting_for_stop, which keeps an infinite search from reporting its move before stop arrives.
+        std::mutex m_stop_mutex;
+        std::condition_variable m_stop_condition;
+        bool m_waiting_for_stop = false;
+
+        void send(const std::string& line)
+        {
+            std::lock_guard<std::mutex> lock(m_output_mutex);
+            std::cout << line << std::endl;
+        }
+
+        /**
+         * @brief Ends the running search, if any, and waits until it has reported its best move.
+         */
+        void stopSearch()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_stop_mutex);
+                m_waiting_for_stop = false;
+            }
+            m_stop_condition.notify_all();
+            m_engine.stop();
+            if (m_search_thread.joinable()) {
+                m_search_thread.join();
+            }
+        }
+
+        void handlePosition(std::istringstream& arguments)
+        {
+            std::string token;
+            arguments >> token;
+            std::string fen;
+            if (token == "startpos") {
+                fen = start_position;
+                arguments >> token;
+            } else if (token == "fen") {
+                while (arguments >> token && token != "moves") {
+                    fen += token + ' ';
+                }
+            } else {
+                send("info string expected startpos or fen");
+                return;
+            }
+            try {
+                GameState state = GameState::fromFEN(fen);
+                while (arguments >> token) {
+                    const std::optional<Move> move = state.findMove(token);
+                    if (!move.has_value()) {
+                        send("info string illegal move " + token);
+                        break;
+                    }
+                    state.move(move.value());
+                }
+                m_state = state;
+            } catch (const std::invalid_argument& error) {
+                send(std::string("info string invalid position: ") + error.what());
+            }
+        }
+
+        void handleGo(std::istringstream& arguments)
+        {
+            SearchLimits limits;
+            limits.depth = Engine::max_ply;
+            int time_left[2] = { 0, 0 };
+            int increment[2] = { 0, 0 };
+            int moves_to_go = 0;
+            bool infinite = false;
+            std::string token;
+            while (arguments >> token) {
+                if (token == "depth") {
+                    arguments >> limits.depth;
+                } else if (token == "movetime") {
+                    arguments >> limits.movetime;
+                } else if (token == "nodes") {
+                    arguments >> limits.nodes;
+                } else if (token == "wtime") {
+                    arguments >> time_left[static_cast<int>(PieceColor::White)];
+                } else if (token == "btime") {
+                    arguments >> time_left[static_cast<int>(PieceColor::Black)];
+                } else if (token == "winc") {
+                    arguments >> increment[static_cast<int>(PieceColor::White)];
+                } else if (token == "binc") {
+                    arguments >> increment[static_cast<int>(PieceColor::Black)];
+                } else if (token == "movestogo") {
+                    arguments >> moves_to_go;
+                } else if (token == "infinite") {
+                    infinite = true;
+                }
+            }
+            const int color = static_cast<int>(m_state.getTurnColor());
+            if (limits.movetime == 0 && time_left[color] > 0 && !infinite) {
+                // Spend an even share of the remaining time plus most of the increment, without ever running out.
+                const int share = time_left[color] / (moves_to_go > 0 ? moves_to_go : default_moves_to_go) + increment[color] * 3 / 4;
+                limits.movetime = std::max(1, std::min(share, time_left[color] - move_overhead));
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_stop_mutex);
+                m_waiting_for_stop = infinite;
+            }
+            // A stop that arrives before the thread reaches the search must still end it.
+            m_engine.prepareSearch();
+            m_search_thread = std::thread([this, limits]() {
+                const auto start = std::chrono::steady_clock::now();
+                std::uint64_t previous_total = 0;
+                std::uint64_t previous_iteration = 0;
+                std::uint64_t previous_beta_cutoffs = 0;
+                std::uint64_t previous_first_move_cutoffs = 0;
+                const SearchResult result = m_engine.search(m_state, limits, [&, this, start](const SearchResult& iteration) {
+                    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+                    std::string line = "info depth " + std::to_string(iteration.depth) + " score " + scoreToUci(iteration.score)
+                        + " nodes " + std::to_string(iteration.nodes) + " nps " + std::to_string(elapsed > 0 ? iteration.nodes * 1000 / elapsed : 0)
+                        + " time " + std::to_string(elapsed) + " hashfull " + std::to_string(m_engine.hashfull()) + " pv";
+                    for (const Move move : iteration.pv) {
+                        line += ' ' + move.toCoordinateNotation();
+                    }
+                    send(line);
+                    // The effective branching factor is how many times more nodes this iteration took than the last.
+                    const std::uint64_t iteration_nodes = iteration.nodes - previous_total;
+                    // The cutoffs are totals of the search too, so the rate of this iteration comes from the differences.
+                    const std::uint64_t beta_cutoffs = iteration.beta_cutoffs - previous_beta_cutoffs;
+                    const std::uint64_t first_move_cutoffs = iteration.first_move_cutoffs - previous_first_move_cutoffs;
+                    std::ostringstream statistics;
+                    statistics << std::fixed << std::setprecision(2) << "info string depth " << iteration.depth << " ebf "
+                               << (previous_iteration > 0 ? static_cast<double>(iteration_nodes) / previous_iteration : 0.0)
+                               << " first move cutoffs "
+                               << (beta_cutoffs > 0 ? 100.0 * first_move_cutoffs / beta_cutoffs : 0.0) << '%';
+                    send(statistics.str());
+                    previous_total = iteration.nodes;
+                    previous_iteration = iteration_nodes;
+                    previous_beta_cutoffs = iteration.beta_cutoffs;
+                    previous_first_move_cutoffs = iteration.first_move_cutoffs;
+                });
+                // UCI forbids reporting the move of an infinite search before stop, even if the search is over.
+                std::unique_lock<std::mutex> lock(m_stop_mutex);
+                m_stop_condition.wait(lock, [this]() { return !m_waiting_for_stop; });
+                lock.unlock();
+                send("bestmove " + (result.best_move == Move() ? std::string("0000") : result.best_move.toCoordinateNotation()));
+            });
+        }
+
+        void handleSetOption(std::istringstream& arguments)
+        {
+            std::string token;
+            std::string name;
+            std::string value;
+            arguments >> token;
+            while (arguments >> token && token != "value") {
+                name += (name.empty() ? "" : " ") + token;
+            }
+            // The value is the rest of the line, which can contain spaces in the case of paths.
+            std::getline(arguments >> std::ws, value);
+            if (name == "Hash") {
+                m_engine.setHashSize(std::max(std::atoi(value.c_str()), 1));
+            } else if (name == "Threads") {
+                m_engine.setThreads(std::max(std::atoi(value.c_str()), 1));
+            } else if (name == "BookFile") {
+                try {
+                    m_engine.setBook(value.empty() || value == "<empty>" ? nullptr : std::make_shared<const OpeningBook>(value));
+                } catch (const std::runtime_error& error) {
+                    m_engine.setBook(nullptr);
+                    send(std::string("info string ") + error.what());
+                }
+            } else {
+                send("info string unknown option " + name);
+            }
+        }
+
+    public:
+        UciSession()
+            : m_state(GameState::fromFEN(start_position))
+        {
+        }
+
+        ~UciSession()
+        {
+            stopSearch();
+        }
+
+        /**
+         * @brief Answers commands from the standard input until quit or the end of the input.
+         */
+        void run()
+        {
+            std::string line;
+            while (std::getline(std::cin, line)) {
+                std::istringstream arguments(line);
+                std::string command;
+                arguments >> command;
+                if (command == "uci") {
+                    send("id name Chess\nid author the Chess contributors\n"
+                         "option name Hash type spin default 16 min 1 max 65536\n"
+                         "option name Threads type spin default 1 min 1 max 256\n"
+                         "option name BookFile type string default <empty>\nuciok");
+                } else if (command == "isready") {
+                    send("readyok");
+                } else if (command == "ucinewgame") {
+                    stopSearch();
+                    m_engine.clearHash();
+                } else if (command == "position") {
+                    stopSearch();
+                    handlePosition(arguments);
+                } else if (command == "go") {
+                    stopSearch();
+                    handleGo(arguments);
+                } else if (command == "stop") {
+                    stopSearch();
+                } else if (command == "setoption") {
+                    stopSearch();
+                    handleSetOption(arguments);
+                } else if (command == "quit") {
+                    break;
+                } else if (!command.empty()) {
+                    send("info string unknown command " + command);
+                }
+            }
+        }
+    };
+}
+
+int main()
+{
+    UciSession session;
+    session.run();
+    return EXIT_SUCCESS;
+}